@@ -0,0 +1,47 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __BENCHMARKS_H
+#define __BENCHMARKS_H
+
+#include <QString>
+#include <memory>
+
+class QDir;
+
+namespace NVSProjectMaker
+{
+    struct SScanSettings;
+
+    namespace NBenchmarks
+    {
+        // walks the tree with 1, 2, 4... up to one thread per core, then twice with a cache, reporting the time of each and whether the trees match
+        QString sourceScan( const std::shared_ptr< const SScanSettings > & settings, const QDir & sourceDir );
+
+        // builds a large tree in memory, reports the memory its names take against full paths and
+        // the time to rebuild every path, and counts the rebuilt paths that differ
+        QString relPathCache();
+    }
+}
+
+#endif
@@ -0,0 +1,107 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "Benchmarks.h"
+#include "MainLib/Settings.h"
+#include "MainLib/DirInfo.h"
+#include "MainLib/FlatSourceTree.h"
+
+#include <chrono>
+#include <unordered_map>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    QString NBenchmarks::relPathCache()
+    {
+        // 6 levels of 4 directories with 80 files in each, about 440k nodes
+        auto root = std::make_shared< SSourceFileInfo >();
+        root->fIsDir = true;
+        std::vector< const SSourceFileInfo * > nodes;
+        std::unordered_map< const SSourceFileInfo *, QString > fullPaths; // what each node stored before
+        std::vector< std::pair< std::shared_ptr< SSourceFileInfo >, int > > stack = { { root, 0 } };
+        while ( !stack.empty() )
+        {
+            auto dir = stack.back().first;
+            auto depth = stack.back().second;
+            stack.pop_back();
+            auto && dirPath = fullPaths[ dir.get() ];
+            for ( int ii = ( depth < 6 ) ? 0 : 4; ii < 84; ++ii )
+            {
+                auto node = std::make_shared< SSourceFileInfo >();
+                node->fIsDir = ii < 4;
+                node->fName = node->fIsDir ? QString( "component_level%1_%2" ).arg( depth ).arg( ii ) : QString( "source_file_%1.cpp" ).arg( ii );
+                node->fParent = dir.get();
+                dir->fChildren.push_back( node );
+                nodes.push_back( node.get() );
+                fullPaths[ node.get() ] = dirPath.isEmpty() ? node->fName : ( dirPath + "/" + node->fName );
+                if ( node->fIsDir )
+                    stack.push_back( { node, depth + 1 } );
+            }
+        }
+
+        auto stringBytes = []( const QString & str ) { return sizeof( QArrayData ) + ( str.capacity() + 1 ) * sizeof( QChar ); };
+        size_t pathBytes = 0;
+        size_t nameBytes = 0;
+        for ( auto && ii : nodes )
+        {
+            pathBytes += stringBytes( fullPaths[ ii ] );
+            nameBytes += stringBytes( ii->fName ) + sizeof( ii->fParent );
+        }
+
+        int mismatches = 0;
+        auto start = std::chrono::steady_clock::now();
+        QString buffer;
+        for ( auto && ii : nodes )
+        {
+            ii->getRelPath( buffer );
+            mismatches += ( buffer != fullPaths[ ii ] ) ? 1 : 0;
+        }
+        auto bufferMSecs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+        start = std::chrono::steady_clock::now();
+        CRelPathCache paths;
+        for ( auto && ii : nodes )
+            mismatches += ( paths.relPath( ii ) != fullPaths[ ii ] ) ? 1 : 0;
+        auto cacheMSecs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+        // the projects are generated from the flat tree, its names must give the same project paths and files
+        CFlatSourceTree tree( root );
+        for ( int ii = 1; ii < tree.size(); ++ii )
+        {
+            if ( !tree.isDir( ii ) )
+                continue;
+            auto info = SDirInfo( tree, ii );
+            QStringList files;
+            for ( auto && jj : tree.sourceInfo( ii )->fChildren )
+            {
+                if ( !jj->fIsDir )
+                    files << fullPaths[ jj.get() ];
+            }
+            mismatches += ( ( info.fRelToDir != fullPaths[ tree.sourceInfo( ii ).get() ] ) || ( info.fSourceFiles != files ) ) ? 1 : 0;
+        }
+
+        return QString( "Nodes: %1 Full Paths: %2KB Names: %3KB Saved: %4KB\n" ).arg( nodes.size() ).arg( pathBytes / 1024 ).arg( nameBytes / 1024 ).arg( ( pathBytes - nameBytes ) / 1024 )
+            + QString( "Rebuilt Into One Buffer: %1ms Rebuilt With Directory Cache: %2ms Mismatches: %3" ).arg( bufferMSecs ).arg( cacheMSecs ).arg( mismatches );
+    }
+}
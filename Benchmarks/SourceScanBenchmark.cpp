@@ -0,0 +1,87 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "Benchmarks.h"
+#include "MainLib/SourceTreeWalker.h"
+
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <thread>
+
+namespace NVSProjectMaker
+{
+    QString NBenchmarks::sourceScan( const std::shared_ptr< const SScanSettings > & settings, const QDir & sourceDir )
+    {
+        auto maxThreads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency() ) );
+        std::list< int > threadCounts;
+        for ( int ii = 1; ii < maxThreads; ii *= 2 )
+            threadCounts.push_back( ii );
+        threadCounts.push_back( maxThreads );
+
+        // the first walk warms the file system cache, so every timed walk reads the same way
+        CSourceTreeWalker( settings, sourceDir ).walk( sourceDir.absolutePath(), std::make_shared< SSourceFileInfo >(), maxThreads );
+
+        QStringList retVal;
+        QStringList serialListing;
+        double serialMSecs = 0;
+        for ( auto && numThreads : threadCounts )
+        {
+            auto root = std::make_shared< SSourceFileInfo >();
+            auto start = std::chrono::steady_clock::now();
+            CSourceTreeWalker( settings, sourceDir ).walk( sourceDir.absolutePath(), root, numThreads );
+            auto msecs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+            auto currListing = CSourceTreeWalker::listing( root );
+            if ( numThreads == 1 )
+            {
+                serialListing = currListing;
+                serialMSecs = msecs;
+            }
+            retVal << QString( "Threads: %1 Time: %2ms Speedup: %3 Nodes: %4 Matches Serial: %5" ).arg( numThreads ).arg( msecs ).arg( msecs ? ( serialMSecs / msecs ) : 0.0 ).arg( currListing.count() ).arg( ( currListing == serialListing ) ? "Yes" : "No" );
+        }
+
+        // the first cached walk fills the cache, the second shows a rescan of an unchanged tree
+        auto cacheFile = QDir::temp().absoluteFilePath( "NVSProjectMaker-scan-benchmark.scancache" );
+        QFile::remove( cacheFile );
+        for ( auto && pass : { "Filling Cache", "Rescan From Cache" } )
+        {
+            auto cache = std::make_shared< CSourceScanCache >( cacheFile, sourceDir.absolutePath() );
+            cache->load();
+            auto root = std::make_shared< SSourceFileInfo >();
+            auto start = std::chrono::steady_clock::now();
+            CSourceTreeWalker walker( settings, sourceDir );
+            walker.setCache( cache );
+            walker.walk( sourceDir.absolutePath(), root, maxThreads );
+            cache->save();
+            auto msecs = std::chrono::duration< double, std::milli >( std::chrono::steady_clock::now() - start ).count();
+
+            retVal << QString( "%1: Time: %2ms Listed: %3 Reused: %4 Matches Serial: %5" ).arg( pass ).arg( msecs ).arg( walker.numListed() ).arg( walker.numReused() ).arg( ( CSourceTreeWalker::listing( root ) == serialListing ) ? "Yes" : "No" );
+        }
+        QFile::remove( cacheFile );
+        return retVal.join( "\n" );
+    }
+}
@@ -0,0 +1,76 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "Benchmarks.h"
+#include "MainLib/VSProjectMaker.h"
+#include "MainLib/Settings.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <iostream>
+
+int main(int argc, char ** argv)
+{
+    QCoreApplication appl(argc, argv);
+    Q_INIT_RESOURCE(MainLib);
+    NVSProjectMaker::registerTypes();
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("VS Project Maker Benchmarks");
+    parser.addHelpOption();
+
+    QCommandLineOption optionsFileOption(QStringList() << "options" << "o", "The options INI file, the source tree of its client is scanned by -scan", "Options file");
+    parser.addOption(optionsFileOption);
+    QCommandLineOption scanOption(QStringList() << "scan", "Find the source files with 1, 2, 4... up to one thread per core, print the time of each and whether the trees match, then time a rescan from the scan cache");
+    parser.addOption(scanOption);
+    QCommandLineOption pathMemoryOption(QStringList() << "path-memory", "Build a large synthetic source tree in memory, print the memory its paths take as names against full paths, and check the rebuilt paths");
+    parser.addOption(pathMemoryOption);
+    parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
+    parser.process(appl);
+
+    if (!parser.isSet(scanOption) && !parser.isSet(pathMemoryOption))
+        parser.showHelp(-1);
+
+    if (parser.isSet(pathMemoryOption))
+        std::cout << NVSProjectMaker::NBenchmarks::relPathCache().toStdString() << "\n";
+
+    if (parser.isSet(scanOption))
+    {
+        NVSProjectMaker::CSettings settings;
+        if (!parser.isSet(optionsFileOption) || !settings.loadSettings(parser.value(optionsFileOption)))
+        {
+            std::cerr << "-scan requires an existing -options file\n";
+            return -1;
+        }
+        auto clientDir = QDir(settings.getClientDir());
+        if (!clientDir.exists())
+        {
+            std::cerr << "Client directory '" << clientDir.absolutePath().toStdString() << "' does not exist.\n";
+            return -1;
+        }
+        auto sourceDir = QDir(clientDir.absoluteFilePath(settings.getSourceRelativeDir()));
+        std::cout << NVSProjectMaker::NBenchmarks::sourceScan(settings.getScanSettings(), sourceDir).toStdString() << "\n";
+    }
+    return 0;
+}
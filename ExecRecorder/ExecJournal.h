@@ -0,0 +1,54 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __EXECJOURNAL_H
+#define __EXECJOURNAL_H
+
+/*
+ * Layout of the journal written by the ExecRecorder LD_PRELOAD library and read by
+ * NVSProjectMaker::CExecJournalReader.  Each process that execs or spawns another program
+ * appends to <journal dir>/<pid>.jrnl, one record per call, each record written with a single
+ * write() to a file opened O_APPEND, so the writers never need a lock.
+ *
+ * A record is the fixed header below, followed by the NUL terminated executable as passed to
+ * exec, the NUL terminated working directory and fArgc NUL terminated arguments.
+ */
+
+#include <stdint.h>
+
+#define EXEC_JOURNAL_DIR_ENV "VSPM_EXEC_JOURNAL_DIR"
+#define EXEC_JOURNAL_SUFFIX ".jrnl"
+#define EXEC_JOURNAL_MAGIC 0x4a584556u /* "VEXJ" */
+
+struct SExecJournalRecord
+{
+    uint32_t fMagic;
+    uint32_t fSize; /* of the whole record, header included */
+    uint64_t fTimeNS; /* CLOCK_REALTIME when exec was called */
+    int32_t fPid; /* the process that called exec or spawn */
+    int32_t fPPid;
+    uint32_t fArgc;
+    uint32_t fReserved;
+};
+
+#endif
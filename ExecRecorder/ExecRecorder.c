@@ -0,0 +1,354 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*
+ * LD_PRELOAD library that records every program started by a build, in the spirit of bear:
+ *
+ *     VSPM_EXEC_JOURNAL_DIR=/tmp/journal LD_PRELOAD=/path/to/libExecRecorder.so make
+ *
+ * The exec family and posix_spawn are wrapped, the call is appended to the journal of the
+ * calling process and then handed to the real function.  The real functions are looked up once
+ * when the library is loaded, dlsym takes the loader lock and may allocate, so the wrappers
+ * themselves neither allocate nor take a lock and are safe in a vfork child.  The cost per exec
+ * is one open, write and close.  When the journal directory is not set the calls are passed
+ * straight through.
+ *
+ * A relative journal directory is made absolute when the library is loaded into the first
+ * process, so a make -C further down the build still writes to the same place.  A spawn whose
+ * file actions change directory is recorded with the directory the child starts in.
+ */
+
+#define _GNU_SOURCE
+#include "ExecJournal.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <spawn.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+#define MAX_STACK_RECORD 16384
+#define MAX_LIST_ARGS 4096
+#define MAX_CHDIR_ACTIONS 64
+
+typedef int ( *TExecve )( const char *, char * const[], char * const[] );
+typedef int ( *TExecv )( const char *, char * const[] );
+typedef int ( *TPosixSpawn )( pid_t *, const char *, const posix_spawn_file_actions_t *, const posix_spawnattr_t *, char * const[], char * const[] );
+typedef int ( *TFileActions )( posix_spawn_file_actions_t * );
+typedef int ( *TAddChdir )( posix_spawn_file_actions_t *, const char * );
+typedef int ( *TAddFChdir )( posix_spawn_file_actions_t *, int );
+
+/* set by the constructor, a wrapper only reads them */
+static TExecve sRealExecve;
+static TExecv sRealExecv;
+static TExecve sRealExecvpe;
+static TExecv sRealExecvp;
+static TPosixSpawn sRealPosixSpawn;
+static TPosixSpawn sRealPosixSpawnp;
+static TFileActions sRealFileActionsInit;
+static TFileActions sRealFileActionsDestroy;
+static TAddChdir sRealAddChdir;
+static TAddFChdir sRealAddFChdir;
+
+static void * realFunction( const char * name )
+{
+    return dlsym( RTLD_NEXT, name );
+}
+
+/*
+ * Runs before main in every process the library is loaded into.  Resolves the real functions,
+ * and makes a relative journal directory absolute so the children inherit the absolute path.
+ */
+__attribute__(( constructor )) static void initRecorder( void )
+{
+    sRealExecve = realFunction( "execve" );
+    sRealExecv = realFunction( "execv" );
+    sRealExecvpe = realFunction( "execvpe" );
+    sRealExecvp = realFunction( "execvp" );
+    sRealPosixSpawn = realFunction( "posix_spawn" );
+    sRealPosixSpawnp = realFunction( "posix_spawnp" );
+    sRealFileActionsInit = realFunction( "posix_spawn_file_actions_init" );
+    sRealFileActionsDestroy = realFunction( "posix_spawn_file_actions_destroy" );
+    sRealAddChdir = realFunction( "posix_spawn_file_actions_addchdir_np" );
+    sRealAddFChdir = realFunction( "posix_spawn_file_actions_addfchdir_np" );
+
+    const char * dir = getenv( EXEC_JOURNAL_DIR_ENV );
+    if ( !dir || !*dir || ( *dir == '/' ) )
+        return;
+
+    char cwd[ PATH_MAX ];
+    char absDir[ PATH_MAX ];
+    int len = getcwd( cwd, sizeof( cwd ) ) ? snprintf( absDir, sizeof( absDir ), "%s/%s", cwd, dir ) : -1;
+    if ( ( len > 0 ) && ( len < (int)sizeof( absDir ) ) )
+        setenv( EXEC_JOURNAL_DIR_ENV, absDir, 1 );
+    else
+        unsetenv( EXEC_JOURNAL_DIR_ENV ); /* recording nothing beats scattering journals over the build directories */
+}
+
+/*
+ * The directory set by the chdir file actions of a posix_spawn_file_actions_t, by its address.
+ * Slots are claimed with a compare and swap when an action is added and released when the
+ * actions are destroyed.  When every slot is taken the spawn is recorded with the parent's
+ * working directory.
+ */
+struct SChdirAction
+{
+    const posix_spawn_file_actions_t * fActions;
+    char fDir[ PATH_MAX ];
+};
+static struct SChdirAction sChdirActions[ MAX_CHDIR_ACTIONS ];
+
+static struct SChdirAction * findChdirAction( const posix_spawn_file_actions_t * actions )
+{
+    for ( int ii = 0; actions && ( ii < MAX_CHDIR_ACTIONS ); ++ii )
+    {
+        if ( __atomic_load_n( &sChdirActions[ ii ].fActions, __ATOMIC_ACQUIRE ) == actions )
+            return &sChdirActions[ ii ];
+    }
+    return NULL;
+}
+
+static void releaseChdirAction( const posix_spawn_file_actions_t * actions )
+{
+    struct SChdirAction * slot = findChdirAction( actions );
+    if ( slot )
+        __atomic_store_n( &slot->fActions, NULL, __ATOMIC_RELEASE );
+}
+
+/* a relative path is taken from the directory of the previous chdir action, or the current one */
+static void addChdirAction( const posix_spawn_file_actions_t * actions, const char * path )
+{
+    struct SChdirAction * slot = findChdirAction( actions );
+    for ( int ii = 0; !slot && ( ii < MAX_CHDIR_ACTIONS ); ++ii )
+    {
+        const posix_spawn_file_actions_t * expected = NULL;
+        if ( __atomic_compare_exchange_n( &sChdirActions[ ii ].fActions, &expected, actions, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE ) )
+        {
+            slot = &sChdirActions[ ii ];
+            if ( !getcwd( slot->fDir, sizeof( slot->fDir ) ) )
+                slot->fDir[ 0 ] = 0;
+        }
+    }
+    if ( !slot )
+        return;
+
+    char dir[ PATH_MAX ];
+    int len = ( *path == '/' ) ? snprintf( dir, sizeof( dir ), "%s", path ) : snprintf( dir, sizeof( dir ), "%s/%s", slot->fDir, path );
+    if ( ( len > 0 ) && ( len < (int)sizeof( dir ) ) )
+        memcpy( slot->fDir, dir, len + 1 );
+}
+
+static void record( const char * path, char * const argv[], const posix_spawn_file_actions_t * fileActions )
+{
+    const char * dir = getenv( EXEC_JOURNAL_DIR_ENV );
+    if ( !dir || !*dir || !path )
+        return;
+
+    int savedErrno = errno;
+
+    char cwd[ PATH_MAX ];
+    struct SChdirAction * chdirAction = findChdirAction( fileActions );
+    if ( chdirAction && chdirAction->fDir[ 0 ] )
+        snprintf( cwd, sizeof( cwd ), "%s", chdirAction->fDir );
+    else if ( !getcwd( cwd, sizeof( cwd ) ) )
+        cwd[ 0 ] = 0;
+
+    size_t size = sizeof( struct SExecJournalRecord ) + strlen( path ) + 1 + strlen( cwd ) + 1;
+    uint32_t argc = 0;
+    for ( ; argv && argv[ argc ]; ++argc )
+        size += strlen( argv[ argc ] ) + 1;
+
+    char stackBuffer[ MAX_STACK_RECORD ];
+    char * buffer = stackBuffer;
+    if ( size > sizeof( stackBuffer ) )
+    {
+        buffer = mmap( NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+        if ( buffer == MAP_FAILED )
+        {
+            errno = savedErrno;
+            return;
+        }
+    }
+
+    struct timespec now;
+    clock_gettime( CLOCK_REALTIME, &now );
+
+    struct SExecJournalRecord header;
+    memset( &header, 0, sizeof( header ) );
+    header.fMagic = EXEC_JOURNAL_MAGIC;
+    header.fSize = (uint32_t)size;
+    header.fTimeNS = (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+    header.fPid = (int32_t)getpid();
+    header.fPPid = (int32_t)getppid();
+    header.fArgc = argc;
+
+    char * pos = buffer;
+    memcpy( pos, &header, sizeof( header ) );
+    pos += sizeof( header );
+    pos = stpcpy( pos, path ) + 1;
+    pos = stpcpy( pos, cwd ) + 1;
+    for ( uint32_t ii = 0; ii < argc; ++ii )
+        pos = stpcpy( pos, argv[ ii ] ) + 1;
+
+    char fileName[ PATH_MAX ];
+    int len = snprintf( fileName, sizeof( fileName ), "%s/%d" EXEC_JOURNAL_SUFFIX, dir, (int)header.fPid );
+    if ( ( len > 0 ) && ( len < (int)sizeof( fileName ) ) )
+    {
+        int fd = open( fileName, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644 );
+        if ( fd >= 0 )
+        {
+            ssize_t written = write( fd, buffer, size );
+            (void)written;
+            close( fd );
+        }
+    }
+
+    if ( buffer != stackBuffer )
+        munmap( buffer, size );
+    errno = savedErrno;
+}
+
+int execve( const char * path, char * const argv[], char * const envp[] )
+{
+    record( path, argv, NULL );
+    return sRealExecve ? sRealExecve( path, argv, envp ) : ( errno = ENOSYS, -1 );
+}
+
+int execv( const char * path, char * const argv[] )
+{
+    record( path, argv, NULL );
+    return sRealExecv ? sRealExecv( path, argv ) : ( errno = ENOSYS, -1 );
+}
+
+int execvpe( const char * file, char * const argv[], char * const envp[] )
+{
+    record( file, argv, NULL );
+    return sRealExecvpe ? sRealExecvpe( file, argv, envp ) : ( errno = ENOSYS, -1 );
+}
+
+int execvp( const char * file, char * const argv[] )
+{
+    record( file, argv, NULL );
+    return sRealExecvp ? sRealExecvp( file, argv ) : ( errno = ENOSYS, -1 );
+}
+
+/* the list forms are turned into argv on the stack and go through the wrappers above */
+#define COLLECT_ARGS( argv, arg, args ) \
+    char * argv[ MAX_LIST_ARGS + 1 ]; \
+    int argc = 0; \
+    argv[ argc++ ] = (char *)arg; \
+    while ( argv[ argc - 1 ] && ( argc <= MAX_LIST_ARGS ) ) \
+        argv[ argc++ ] = va_arg( args, char * ); \
+    if ( argv[ argc - 1 ] ) \
+    { \
+        va_end( args ); \
+        errno = E2BIG; \
+        return -1; \
+    }
+
+int execl( const char * path, const char * arg, ... )
+{
+    va_list args;
+    va_start( args, arg );
+    COLLECT_ARGS( argv, arg, args );
+    va_end( args );
+    return execve( path, argv, environ );
+}
+
+int execlp( const char * file, const char * arg, ... )
+{
+    va_list args;
+    va_start( args, arg );
+    COLLECT_ARGS( argv, arg, args );
+    va_end( args );
+    return execvp( file, argv );
+}
+
+int execle( const char * path, const char * arg, ... )
+{
+    va_list args;
+    va_start( args, arg );
+    COLLECT_ARGS( argv, arg, args );
+    char * const * envp = va_arg( args, char * const * );
+    va_end( args );
+    return execve( path, argv, envp );
+}
+
+int posix_spawn( pid_t * pid, const char * path, const posix_spawn_file_actions_t * fileActions, const posix_spawnattr_t * attrp, char * const argv[], char * const envp[] )
+{
+    record( path, argv, fileActions );
+    return sRealPosixSpawn ? sRealPosixSpawn( pid, path, fileActions, attrp, argv, envp ) : ENOSYS;
+}
+
+int posix_spawnp( pid_t * pid, const char * file, const posix_spawn_file_actions_t * fileActions, const posix_spawnattr_t * attrp, char * const argv[], char * const envp[] )
+{
+    record( file, argv, fileActions );
+    return sRealPosixSpawnp ? sRealPosixSpawnp( pid, file, fileActions, attrp, argv, envp ) : ENOSYS;
+}
+
+int posix_spawn_file_actions_init( posix_spawn_file_actions_t * fileActions )
+{
+    releaseChdirAction( fileActions ); /* the address of actions that were never destroyed */
+    return sRealFileActionsInit ? sRealFileActionsInit( fileActions ) : ENOSYS;
+}
+
+int posix_spawn_file_actions_destroy( posix_spawn_file_actions_t * fileActions )
+{
+    releaseChdirAction( fileActions );
+    return sRealFileActionsDestroy ? sRealFileActionsDestroy( fileActions ) : ENOSYS;
+}
+
+int posix_spawn_file_actions_addchdir_np( posix_spawn_file_actions_t * fileActions, const char * path )
+{
+    int retVal = sRealAddChdir ? sRealAddChdir( fileActions, path ) : ENOSYS;
+    if ( retVal == 0 )
+        addChdirAction( fileActions, path );
+    return retVal;
+}
+
+int posix_spawn_file_actions_addfchdir_np( posix_spawn_file_actions_t * fileActions, int fd )
+{
+    int retVal = sRealAddFChdir ? sRealAddFChdir( fileActions, fd ) : ENOSYS;
+    if ( retVal == 0 )
+    {
+        char fdPath[ 64 ];
+        char dir[ PATH_MAX ];
+        snprintf( fdPath, sizeof( fdPath ), "/proc/self/fd/%d", fd );
+        ssize_t len = readlink( fdPath, dir, sizeof( dir ) - 1 );
+        if ( len > 0 )
+        {
+            dir[ len ] = 0;
+            addChdirAction( fileActions, dir );
+        }
+    }
+    return retVal;
+}
@@ -0,0 +1,351 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "BinLogReader.h"
+#include "BuildOutputReader.h"
+
+#include <QObject>
+#include <QFileInfo>
+
+namespace NVSProjectMaker
+{
+    static const int kMinFileFormatVersion = 18; // first version where every record is length prefixed
+    static const int kStringStartIndex = 10; // string references below this are reserved, 0 is null and 1 is empty
+    static const int kMaxRecordSize = 256 * 1024 * 1024;
+    static const qint64 kTicksPerMS = 10000;
+
+    // BuildEventArgsFieldFlags
+    enum EFieldFlags
+    {
+        eBuildEventContext = 1 << 0,
+        eHelpKeyword = 1 << 1,
+        eMessage = 1 << 2,
+        eSenderName = 1 << 3,
+        eThreadId = 1 << 4,
+        eTimestamp = 1 << 5,
+        eSubcategory = 1 << 6,
+        eCode = 1 << 7,
+        eFile = 1 << 8,
+        eProjectFile = 1 << 9,
+        eLineNumber = 1 << 10,
+        eColumnNumber = 1 << 11,
+        eEndLineNumber = 1 << 12,
+        eEndColumnNumber = 1 << 13,
+        eArguments = 1 << 14,
+        eImportance = 1 << 15,
+        eExtended = 1 << 16
+    };
+
+    CBinLogReader::CBinLogReader( const QString & fileName ) :
+        fFileName( fileName ),
+        fReader( std::make_unique< CBuildOutputReader >( fileName ) )
+    {
+    }
+
+    CBinLogReader::~CBinLogReader()
+    {
+    }
+
+    bool CBinLogReader::isBinLog( const QString & fileName )
+    {
+        return QFileInfo( fileName ).suffix().compare( "binlog", Qt::CaseInsensitive ) == 0;
+    }
+
+    qint64 CBinLogReader::size() const
+    {
+        return fReader->size();
+    }
+
+    qint64 CBinLogReader::pos() const
+    {
+        return fReader->pos();
+    }
+
+    void CBinLogReader::setError( const QString & msg )
+    {
+        fStatus = std::make_pair( false, msg );
+    }
+
+    bool CBinLogReader::open()
+    {
+        if ( !fReader->open() )
+        {
+            setError( fReader->errorString() );
+            return false;
+        }
+
+        // the header is two fixed size little endian ints, the format version and the oldest reader version that can read it
+        char header[ 8 ];
+        if ( !readRaw( header, 8 ) )
+        {
+            setError( QObject::tr( "'%1' is not an MSBuild binary log" ).arg( QFileInfo( fFileName ).fileName() ) );
+            return false;
+        }
+        fFileFormatVersion = static_cast< uchar >( header[ 0 ] ) | ( static_cast< uchar >( header[ 1 ] ) << 8 ) | ( static_cast< uchar >( header[ 2 ] ) << 16 ) | ( static_cast< uchar >( header[ 3 ] ) << 24 );
+        if ( fFileFormatVersion < kMinFileFormatVersion )
+        {
+            setError( QObject::tr( "'%1' is MSBuild binary log version %2, version %3 or newer (MSBuild 17.8) is required" ).arg( QFileInfo( fFileName ).fileName() ).arg( fFileFormatVersion ).arg( kMinFileFormatVersion ) );
+            return false;
+        }
+        fStatus = std::make_pair( true, QString() );
+        return true;
+    }
+
+    bool CBinLogReader::readTask( SBinLogTask & task )
+    {
+        while ( fReady.empty() )
+        {
+            if ( fAtEnd || !status() )
+                return false;
+            if ( !readRecord() )
+            {
+                if ( !status() )
+                    return false;
+
+                // tasks still running when the log ended, keep their command lines without a duration
+                fAtEnd = true;
+                while ( !fPending.empty() )
+                    finishTask( fPending.begin()->first, -1 );
+            }
+        }
+        task = fReady.front();
+        fReady.pop_front();
+        return true;
+    }
+
+    bool CBinLogReader::readRaw( char * data, qint64 size )
+    {
+        return fReader->read( data, size ) == size;
+    }
+
+    bool CBinLogReader::readStreamInt( int & value )
+    {
+        // .NET 7 bit encoded int
+        value = 0;
+        for ( int shift = 0; shift < 35; shift += 7 )
+        {
+            char curr;
+            if ( !readRaw( &curr, 1 ) )
+                return false;
+            value |= ( static_cast< uchar >( curr ) & 0x7f ) << shift;
+            if ( ( static_cast< uchar >( curr ) & 0x80 ) == 0 )
+                return true;
+        }
+        return false;
+    }
+
+    bool CBinLogReader::readRecord()
+    {
+        int kind = 0;
+        if ( !readStreamInt( kind ) || ( kind == eEndOfFile ) )
+            return false;
+
+        int length = 0;
+        if ( !readStreamInt( length ) || ( length < 0 ) || ( length > kMaxRecordSize ) )
+        {
+            setError( QObject::tr( "'%1' is corrupt, record %2 has no valid length" ).arg( QFileInfo( fFileName ).fileName() ).arg( fRecordNum ) );
+            return false;
+        }
+        fRecord.resize( length );
+        if ( !readRaw( fRecord.data(), length ) )
+        {
+            setError( QObject::tr( "'%1' is truncated in record %2" ).arg( QFileInfo( fFileName ).fileName() ).arg( fRecordNum ) );
+            return false;
+        }
+        fRecordPos = 0;
+        fRecordNum++;
+
+        // a record that does not decode as expected is skipped, the length prefix keeps the stream in sync
+        switch ( kind )
+        {
+            case eString:
+                // the string's own length prefix stands in for the record length, the payload is the text
+                fStrings.push_back( QString::fromUtf8( fRecord ) );
+                break;
+            case eTaskStarted:
+            {
+                SEventFields fields;
+                QString taskName;
+                QString projectFile;
+                if ( !readFields( fields, false ) || !readStringRef( taskName ) || !readStringRef( projectFile ) )
+                    break;
+                auto && pending = fPending[ fields.fContext ];
+                pending.fStartTime = fields.fTimeStamp;
+                pending.fTaskName = taskName;
+                pending.fProjectFile = projectFile;
+                break;
+            }
+            case eTaskCommandLine:
+            {
+                SEventFields fields;
+                QString commandLine;
+                QString taskName;
+                if ( !readFields( fields, true ) || !readStringRef( commandLine ) || !readStringRef( taskName ) || commandLine.isEmpty() )
+                    break;
+                auto && pending = fPending[ fields.fContext ];
+                if ( pending.fTaskName.isEmpty() )
+                    pending.fTaskName = taskName;
+                if ( pending.fCommandLines.isEmpty() )
+                    pending.fRecordNum = fRecordNum;
+                pending.fCommandLines << commandLine;
+                break;
+            }
+            case eTaskFinished:
+            {
+                SEventFields fields;
+                if ( !readFields( fields, false ) )
+                    break;
+                finishTask( fields.fContext, fields.fTimeStamp );
+                break;
+            }
+            default:
+                break;
+        }
+        return true;
+    }
+
+    void CBinLogReader::finishTask( const TBuildEventContext & context, qint64 finishTime )
+    {
+        auto pos = fPending.find( context );
+        if ( pos == fPending.end() )
+            return;
+
+        auto && pending = ( *pos ).second;
+        for ( auto && ii : pending.fCommandLines )
+        {
+            SBinLogTask task;
+            task.fTaskName = pending.fTaskName;
+            task.fCommandLine = ii;
+            task.fProjectFile = pending.fProjectFile;
+            if ( ( finishTime >= 0 ) && ( pending.fStartTime >= 0 ) )
+                task.fDurationMS = ( finishTime - pending.fStartTime ) / kTicksPerMS;
+            task.fRecordNum = pending.fRecordNum;
+            fReady.push_back( task );
+        }
+        fPending.erase( pos );
+    }
+
+    bool CBinLogReader::readInt( int & value )
+    {
+        value = 0;
+        for ( int shift = 0; shift < 35; shift += 7 )
+        {
+            if ( fRecordPos >= fRecord.size() )
+                return false;
+            auto curr = static_cast< uchar >( fRecord[ fRecordPos++ ] );
+            value |= ( curr & 0x7f ) << shift;
+            if ( ( curr & 0x80 ) == 0 )
+                return true;
+        }
+        return false;
+    }
+
+    bool CBinLogReader::readInt64( qint64 & value )
+    {
+        // fixed size little endian, as written by BinaryWriter
+        if ( ( fRecordPos + 8 ) > fRecord.size() )
+            return false;
+        quint64 tmp = 0;
+        for ( int ii = 7; ii >= 0; --ii )
+            tmp = ( tmp << 8 ) | static_cast< uchar >( fRecord[ fRecordPos + ii ] );
+        fRecordPos += 8;
+        value = static_cast< qint64 >( tmp );
+        return true;
+    }
+
+    bool CBinLogReader::readStringRef( QString & value )
+    {
+        int index = 0;
+        if ( !readInt( index ) )
+            return false;
+        if ( index < kStringStartIndex )
+        {
+            value.clear();
+            return true;
+        }
+        index -= kStringStartIndex;
+        if ( index >= static_cast< int >( fStrings.size() ) )
+            return false;
+        value = fStrings[ index ];
+        return true;
+    }
+
+    bool CBinLogReader::readFields( SEventFields & fields, bool readImportance )
+    {
+        // BuildEventArgsReader.ReadBuildEventArgsFields, the flags tell which of the fields were written
+        int flags = 0;
+        if ( !readInt( flags ) )
+            return false;
+
+        QString unused;
+        int unusedInt = 0;
+        if ( ( flags & eMessage ) && !readStringRef( unused ) )
+            return false;
+        if ( flags & eBuildEventContext )
+        {
+            for ( auto && ii : fields.fContext )
+            {
+                if ( !readInt( ii ) )
+                    return false;
+            }
+        }
+        if ( ( flags & eThreadId ) && !readInt( unusedInt ) )
+            return false;
+        if ( ( flags & eHelpKeyword ) && !readStringRef( unused ) )
+            return false;
+        if ( ( flags & eSenderName ) && !readStringRef( unused ) )
+            return false;
+        if ( flags & eTimestamp )
+        {
+            int kind = 0;
+            if ( !readInt64( fields.fTimeStamp ) || !readInt( kind ) )
+                return false;
+        }
+        if ( flags & eExtended )
+            return false; // custom event data, never written for the task events
+        for ( auto && ii : { eSubcategory, eCode, eFile, eProjectFile } )
+        {
+            if ( ( flags & ii ) && !readStringRef( unused ) )
+                return false;
+        }
+        for ( auto && ii : { eLineNumber, eColumnNumber, eEndLineNumber, eEndColumnNumber } )
+        {
+            if ( ( flags & ii ) && !readInt( unusedInt ) )
+                return false;
+        }
+        if ( flags & eArguments )
+        {
+            int count = 0;
+            if ( !readInt( count ) )
+                return false;
+            for ( int ii = 0; ii < count; ++ii )
+            {
+                if ( !readStringRef( unused ) )
+                    return false;
+            }
+        }
+        if ( readImportance && ( flags & eImportance ) && !readInt( unusedInt ) )
+            return false;
+        return true;
+    }
+}
@@ -0,0 +1,130 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __BINLOGREADER_H
+#define __BINLOGREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <array>
+#include <deque>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    class CBuildOutputReader;
+
+    // one tool command line logged by an MSBuild task
+    struct SBinLogTask
+    {
+        QString fTaskName; // CL, Link, Lib...
+        QString fCommandLine;
+        QString fProjectFile;
+        qint64 fDurationMS{ -1 }; // -1 when the log holds no TaskFinished for the task
+        int fRecordNum{ 0 }; // record in the log holding the command line
+    };
+
+    // Streams the records of an MSBuild binary log (msbuild -bl), no MSBuild or Windows needed.
+    // Only the string, TaskStarted, TaskCommandLine and TaskFinished records are decoded, every other
+    // record is skipped using its length prefix, which requires file format 18 (MSBuild 17.8) or newer.
+    class CBinLogReader
+    {
+    public:
+        CBinLogReader( const QString & fileName );
+        ~CBinLogReader();
+
+        bool open();
+
+        bool status() const { return fStatus.first; }
+        QString errorString() const { return fStatus.second; }
+
+        int fileFormatVersion() const { return fFileFormatVersion; }
+        qint64 size() const; // size on disk
+        qint64 pos() const; // bytes on disk consumed so far, safe to call from any thread
+        int recordNum() const { return fRecordNum; }
+
+        // returns false at the end of the log or on an error, check status()
+        // a task that logged several command lines is returned once per command line
+        bool readTask( SBinLogTask & task );
+
+        static bool isBinLog( const QString & fileName );
+    private:
+        enum ERecordKind
+        {
+            eEndOfFile = 0,
+            eTaskStarted = 7,
+            eTaskFinished = 8,
+            eTaskCommandLine = 12,
+            eString = 24
+        };
+
+        using TBuildEventContext = std::array< int, 7 >;
+        struct SEventFields
+        {
+            TBuildEventContext fContext{};
+            qint64 fTimeStamp{ -1 }; // .NET ticks, 100ns
+        };
+        struct SPendingTask
+        {
+            qint64 fStartTime{ -1 };
+            QString fTaskName;
+            QString fProjectFile;
+            QStringList fCommandLines;
+            int fRecordNum{ 0 };
+        };
+
+        bool readRecord();
+        void finishTask( const TBuildEventContext & context, qint64 finishTime );
+
+        bool readRaw( char * data, qint64 size );
+        bool readStreamInt( int & value );
+
+        // readers over the payload of the current record
+        bool readInt( int & value );
+        bool readInt64( qint64 & value );
+        bool readStringRef( QString & value );
+        bool readFields( SEventFields & fields, bool readImportance );
+
+        void setError( const QString & msg );
+
+        QString fFileName;
+        std::unique_ptr< CBuildOutputReader > fReader;
+        int fFileFormatVersion{ 0 };
+        int fRecordNum{ 0 };
+        bool fAtEnd{ false };
+
+        QByteArray fRecord;
+        int fRecordPos{ 0 };
+
+        std::vector< QString > fStrings;
+        std::map< TBuildEventContext, SPendingTask > fPending;
+        std::deque< SBinLogTask > fReady;
+
+        std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
+    };
+}
+
+#endif
@@ -21,136 +21,604 @@
 // SOFTWARE.
 
 #include "BuildInfoData.h"
+#include "BuildInfoDatabase.h"
+#include "BinLogReader.h"
+#include "BuildOutputReader.h"
+#include "ExecJournalReader.h"
+#include "FileClassifier.h"
 #include "Settings.h"
 
 #include <QObject>
+#include <QDir>
 #include <QFileInfo>
 #include <QRegularExpression>
-#include <QTextStream>
 #include <QDebug>
 #include <QProgressDialog>
 #include <QStandardItemModel>
+#include <QThread>
+
+#include <algorithm>
+#include <chrono>
+#include <future>
 
 namespace NVSProjectMaker
 {
-    CBuildInfoData::CBuildInfoData( const QString & fileName, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress ) :
+    CBuildInfoData::CBuildInfoData( const QString & fileName, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats ) :
+        CBuildInfoData( expandFileNames( fileName ), reportFunc, settings, progress, collectStats )
+    {
+    }
+
+    CBuildInfoData::CBuildInfoData( const QStringList & fileNames, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats ) :
         fReportFunc( reportFunc ),
         fSettings( settings )
     {
-        QFileInfo fi( fileName );
-        if ( !fi.exists() || !fi.isFile() || !fi.isReadable() )
+        fStats.fEnabled = collectStats;
+        if ( fileNames.isEmpty() )
         {
-            fStatus.second = QObject::tr( "'%1' is not readable or does not exist" ).arg( fileName );
+            fStatus.second = QObject::tr( "No build output files were specified" );
             fStatus.first = false;
             return;
         }
 
-        QFile file( fileName );
-        if ( !file.open( QFile::ReadOnly | QFile::Text ) )
+        for ( auto && ii : fileNames )
+        {
+            QFileInfo fi( ii );
+            if ( !fi.exists() || !( fi.isFile() || CExecJournalReader::isJournalDir( ii ) ) || !fi.isReadable() )
+            {
+                fStatus.second = QObject::tr( "'%1' is not readable or does not exist" ).arg( ii );
+                fStatus.first = false;
+                return;
+            }
+        }
+        fLazyOptions = fSettings->getDecodeOptionsOnDemand();
+
+        if ( ( fileNames.count() == 1 ) && CBuildInfoDatabase::isDatabase( fileNames.front() ) )
+        {
+            fStatus = CBuildInfoDatabase::importData( *this, fileNames.front() );
+            if ( fStatus.first )
+                fReportFunc( QObject::tr( "Loaded %1 items from '%2'" ).arg( static_cast< int >( fItems.size() ) ).arg( fileNames.front() ) );
+            return;
+        }
+
+        fLogFiles = fileNames;
+        loadLogs( fileNames, progress );
+    }
+
+    CBuildInfoData::CBuildInfoData( const SMakeDryRun & dryRun, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats ) :
+        fReportFunc( reportFunc ),
+        fSettings( settings ),
+        fDryRun( dryRun )
+    {
+        fStats.fEnabled = collectStats;
+        if ( dryRun.fDirs.isEmpty() )
         {
-            fStatus.second = QObject::tr( "'%1' could not be opened for reading" ).arg( fileName );
+            fStatus.second = QObject::tr( "No build directories were specified, load the source directory first" );
             fStatus.first = false;
             return;
         }
+
+        for ( auto && ii : dryRun.fDirs )
+        {
+            QFileInfo fi( ii );
+            if ( !fi.exists() || !fi.isDir() )
+            {
+                fStatus.second = QObject::tr( "Build directory '%1' does not exist" ).arg( ii );
+                fStatus.first = false;
+                return;
+            }
+        }
+        fLogFiles = dryRun.fDirs;
+        fLazyOptions = fSettings->getDecodeOptionsOnDemand();
+
+        loadLogs( fLogFiles, progress, ( dryRun.fMaxProcesses > 0 ) ? dryRun.fMaxProcesses : QThread::idealThreadCount() );
+    }
+
+    QStringList CBuildInfoData::expandFileNames( const QString & fileNames )
+    {
+        QStringList retVal;
+        auto patterns = fileNames.split( ";", Qt::SkipEmptyParts );
+        for ( auto && ii : patterns )
+        {
+            auto pattern = ii.trimmed();
+            if ( pattern.isEmpty() )
+                continue;
+
+            if ( !pattern.contains( QRegularExpression( "[*?\\[]" ) ) )
+            {
+                if ( !retVal.contains( pattern ) )
+                    retVal << pattern;
+                continue;
+            }
+
+            QFileInfo fi( pattern );
+            auto dir = QDir( fi.path() );
+            auto matches = dir.entryList( QStringList() << fi.fileName(), QDir::Files | QDir::Readable, QDir::Name );
+            for ( auto && jj : matches )
+            {
+                auto path = dir.absoluteFilePath( jj );
+                if ( !retVal.contains( path ) )
+                    retVal << path;
+            }
+        }
+        return retVal;
+    }
+
+    void CBuildInfoData::loadLogs( const QStringList & fileNames, QProgressDialog * progress, int maxConcurrent )
+    {
+        // each log is parsed on its own thread into its own result, no shared state is touched until the merge
+        std::vector< std::unique_ptr< SLogResult > > results;
+        qint64 totalSize = 0;
+        for ( int ii = 0; ii < fileNames.count(); ++ii )
+        {
+            results.push_back( std::make_unique< SLogResult >( fileNames[ ii ], ii ) );
+            results.back()->fStats.fEnabled = fStats.fEnabled;
+            results.back()->fSize = ( fDryRun || QFileInfo( fileNames[ ii ] ).isDir() ) ? 0 : QFileInfo( fileNames[ ii ] ).size();
+            totalSize += results.back()->fSize;
+        }
+
         if ( progress )
         {
-            progress->setRange( 0, file.size() );
-            progress->setValue( file.pos() );
+            progress->setRange( 0, 1000 );
+            progress->setValue( 0 );
         }
 
-        QTextStream ts( &file );
-        QString currLine;
-        SStatusInfo statusInfo;
-        while ( ts.readLineInto( &currLine ) )
+        if ( maxConcurrent <= 0 )
+            maxConcurrent = static_cast< int >( results.size() );
+
+        CStageTimer loadTimer( fStats, SBuildLoadStats::eLoad );
+        std::atomic< bool > canceled{ false };
+        std::list< std::future< void > > pending;
+        size_t nextLog = 0;
+        size_t numFinished = 0;
+        while ( ( nextLog < results.size() ) || !pending.empty() )
         {
+            while ( !canceled && ( nextLog < results.size() ) && ( static_cast< int >( pending.size() ) < maxConcurrent ) )
+            {
+                auto result = results[ nextLog++ ].get();
+                result->fRunning = true;
+                pending.push_back( std::async( std::launch::async, [this, result, &canceled]() { loadLog( result, canceled ); result->fRunning = false; } ) );
+            }
+            if ( canceled )
+                nextLog = results.size();
+
+            if ( pending.empty() )
+                continue;
+
+            // wait on whichever of the loads finishes first, the order they were started in does not matter
+            bool finished = false;
+            for ( auto ii = pending.begin(); ii != pending.end(); ++ii )
+            {
+                if ( ( *ii ).wait_for( std::chrono::milliseconds( 0 ) ) == std::future_status::ready )
+                {
+                    ( *ii ).get();
+                    pending.erase( ii );
+                    numFinished++;
+                    finished = true;
+                    break;
+                }
+            }
+            if ( finished )
+                continue;
+            pending.front().wait_for( std::chrono::milliseconds( 50 ) );
+
             if ( progress )
             {
-                progress->setValue( file.pos() );
+                qint64 bytesRead = 0;
+                QStringList labels;
+                for ( auto && ii : results )
+                {
+                    bytesRead += ii->fBytesRead;
+                    if ( ii->fSize )
+                        labels << QString( "<li>%1: %2%</li>" ).arg( QFileInfo( ii->fFileName ).fileName() ).arg( ( 100 * ii->fBytesRead ) / ii->fSize );
+                    else if ( ii->fRunning )
+                        labels << QString( "<li>%1: %2 KB</li>" ).arg( ii->fFileName ).arg( ii->fBytesRead / 1024 );
+                }
+                progress->setLabelText( QString( "<br>Reading Build Output...</br><ul align=\"center\">%1</ul>" ).arg( labels.join( " " ) ) );
+                // a dry run does not know how much make will print, so it counts directories instead
+                progress->setValue( totalSize ? static_cast< int >( ( 1000 * bytesRead ) / totalSize ) : static_cast< int >( ( 1000 * numFinished ) / results.size() ) );
                 if ( progress->wasCanceled() )
-                    break;
+                    canceled = true;
+            }
+        }
+
+        loadTimer.stop();
+
+        if ( canceled )
+        {
+            fReportFunc( QString( "Process Canceled" ) );
+            fStatus = std::make_pair( false, QString( "Process Canceled" ) );
+            return;
+        }
+
+        SStatusInfo statusInfo;
+        for ( auto && ii : results )
+        {
+            if ( !ii->fStatus.first )
+            {
+                fStatus = ii->fStatus;
+                return;
+            }
+
+            if ( results.size() > 1 )
+                fReportFunc( QString( "Build Log: %1" ).arg( ii->fFileName ) );
+            for ( auto && jj : ii->fMessages )
+                fReportFunc( jj );
+
+            statusInfo += ii->fStatusInfo;
+            fStats += ii->fStats;
+            CStageTimer mergeTimer( fStats, SBuildLoadStats::eMerge );
+            statusInfo.fNumRepeats += mergeLog( ii.get() );
+        }
+
+        {
+            CStageTimer dependenciesTimer( fStats, SBuildLoadStats::eDependencies );
+            determineDependencies();
+        }
 
-                auto labelText = statusInfo.getStatusString( fDirectories.size(), true );
-                progress->setLabelText( labelText );
+        if ( fStats.fEnabled )
+        {
+            fStats.fLinesPerTool = statusInfo.linesPerTool();
+            fStats.fItems = static_cast< qint64 >( fItems.size() );
+            fStats.fUniquePaths = fPathPool.size();
+            for ( auto && ii : fItems )
+            {
+                // looking at fOptions directly, options() would decode the lazy items
+                if ( ii->isLazy() )
+                    fStats.fLazyItems++;
+                fStats.fOptionEntries += static_cast< qint64 >( ii->fOptions.size() );
+                int numSet = 0;
+                for ( auto && jj : ii->fOptions )
+                {
+                    if ( std::get< 2 >( jj.second ).has_value() )
+                        numSet++;
+                }
+                fStats.fPeakOptionCount = std::max( fStats.fPeakOptionCount, numSet );
             }
+        }
+        fReportFunc( "Product Dir Usages:" );
+        for ( auto && ii : fProdDirUsages )
+        {
+            fReportFunc( ii );
+        }
+        fReportFunc( "================" );
+        fReportFunc( statusInfo.getStatusString( fDirectories.size(), false ) );
+        fStatus = std::make_pair( true, QString() );
+    }
+
+    template< typename T >
+    void CBuildInfoData::loadTextLog( T & reader, SLogResult * result, const std::atomic< bool > & canceled ) const
+    {
+        if ( !reader.open() )
+        {
+            result->fStatus = std::make_pair( false, reader.errorString() );
+            return;
+        }
+
+        QString currLine;
+        auto && statusInfo = result->fStatusInfo;
+        auto && stats = result->fStats;
+        while ( true )
+        {
+            {
+                CStageTimer readTimer( stats, SBuildLoadStats::eRead );
+                if ( !reader.readLine( currLine ) )
+                    break;
+            }
+            if ( canceled )
+                return;
+            result->fBytesRead = reader.pos();
 
             statusInfo.fLineNum++;
+            // before simplifying, the indentation is the include depth
+            if ( loadShowInclude( currLine, *result ) )
+                continue;
             currLine = currLine.simplified();
-            if ( currLine.isEmpty() )
+            if ( currLine.isEmpty() || trackMakeDirectory( currLine, *result ) )
                 continue;
 
-            if ( loadVSCl( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumCL++;
-            else if ( loadGcc( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumGcc++;
-            else if ( loadLibrary( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumLib++;
-            else if ( loadLink( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumLink++;
-            else if ( loadManifest( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumManifest++;
-            else if ( loadCygwinCC( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumCygwinCC++;
-            else if ( loadObfuscate( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumObfuscate++;
-            else if ( loadMoc( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumMoc++;
-            else if ( loadUic( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumUIC++;
-            else if ( loadRcc( currLine, statusInfo.fLineNum ) )
-                statusInfo.fNumRcc++;
-            else
+            auto item = loadItem( currLine, *result );
+            if ( item )
+                result->fItems.push_back( item );
+        }
+        if ( !reader.status() )
+        {
+            result->fStatus = std::make_pair( false, reader.errorString() );
+            return;
+        }
+        result->fBytesRead = result->fSize;
+        stats.fBytesRead = reader.pos();
+        stats.fLinesRead = statusInfo.fLineNum;
+        result->fStatus = std::make_pair( true, QString() );
+    }
+
+    void CBuildInfoData::loadLog( SLogResult * result, const std::atomic< bool > & canceled ) const
+    {
+        if ( fDryRun )
+        {
+            // commands run in the build directory until make says otherwise
+            result->fDirStack << result->fFileName;
+            CMakeDryRunReader reader( fDryRun.value(), result->fFileName );
+            loadTextLog( reader, result, canceled );
+            if ( result->fStatus.first && ( reader.exitCode() != 0 ) )
+                result->fMessages << QString( "WARNING: '%1' exited with %2 in '%3', the captured commands may be incomplete" ).arg( fDryRun.value().fMakeCommand ).arg( reader.exitCode() ).arg( result->fFileName );
+            return;
+        }
+
+        if ( CBinLogReader::isBinLog( result->fFileName ) )
+            return loadBinLog( result, canceled );
+        if ( CExecJournalReader::isJournalDir( result->fFileName ) )
+            return loadExecJournal( result, canceled );
+
+        CBuildOutputReader reader( result->fFileName );
+        loadTextLog( reader, result, canceled );
+    }
+
+    bool CBuildInfoData::trackMakeDirectory( const QString & line, SLogResult & result ) const
+    {
+        static const QRegularExpression regExp( "^\\S*make(\\.exe)?(\\[\\d+\\])?: (Entering|Leaving) directory [`'\"](.*)['\"]$" );
+        auto match = regExp.match( line );
+        if ( !match.hasMatch() )
+            return false;
+
+        if ( match.captured( 3 ) == "Entering" )
+            result.fDirStack << match.captured( 4 );
+        else if ( !result.fDirStack.isEmpty() )
+            result.fDirStack.pop_back();
+        return true;
+    }
+
+    // rewrites the command line of the CL, Link, Lib and Mt tasks into the form the build output loaders match
+    static QString binLogCommandLine( const SBinLogTask & task )
+    {
+        QString tool;
+        for ( auto && ii : { "cl", "link", "lib", "mt" } )
+        {
+            if ( task.fTaskName.compare( ii, Qt::CaseInsensitive ) == 0 )
+                tool = ii;
+        }
+        if ( tool.isEmpty() )
+            return QString();
+
+        auto cmdLine = task.fCommandLine.simplified();
+        auto match = QRegularExpression( "^(\"[^\"]*\"|\\S+)\\s*" ).match( cmdLine );
+        if ( match.hasMatch() )
+        {
+            auto exe = match.captured( 1 ).remove( '"' );
+            exe = exe.mid( std::max( exe.lastIndexOf( '/' ), exe.lastIndexOf( '\\' ) ) + 1 );
+            if ( ( exe.compare( tool, Qt::CaseInsensitive ) == 0 ) || ( exe.compare( tool + ".exe", Qt::CaseInsensitive ) == 0 ) )
+                cmdLine = cmdLine.mid( match.capturedLength() );
+        }
+        return QString( "/%1.exe %2" ).arg( tool ).arg( cmdLine );
+    }
+
+    void CBuildInfoData::loadBinLog( SLogResult * result, const std::atomic< bool > & canceled ) const
+    {
+        CBinLogReader reader( result->fFileName );
+        if ( !reader.open() )
+        {
+            result->fStatus = std::make_pair( false, reader.errorString() );
+            return;
+        }
+
+        auto && statusInfo = result->fStatusInfo;
+        auto && stats = result->fStats;
+        SBinLogTask task;
+        while ( true )
+        {
+            {
+                CStageTimer readTimer( stats, SBuildLoadStats::eRead );
+                if ( !reader.readTask( task ) )
+                    break;
+            }
+            if ( canceled )
+                return;
+            result->fBytesRead = reader.pos();
+
+            auto line = binLogCommandLine( task );
+            if ( line.isEmpty() )
+                continue;
+
+            // the record holding the command line stands in for the line number
+            statusInfo.fLineNum = task.fRecordNum;
+            auto item = loadItem( line, *result );
+            if ( item )
             {
-                statusInfo.fNumUnloaded++;
-                reportFunc( QString( "ERROR: LineNum: %1 Could not load line: %2" ).arg( statusInfo.fLineNum ).arg( currLine ) );
+                item->fDurationMS = task.fDurationMS;
+                result->fItems.push_back( item );
             }
         }
-        
-        if ( progress && progress->wasCanceled() )
+        if ( !reader.status() )
         {
-            reportFunc( QString( "Process Canceled" ) );
-            fStatus = std::make_pair( false, QString( "Process Canceled" ) );
+            result->fStatus = std::make_pair( false, reader.errorString() );
             return;
         }
+        statusInfo.fLineNum = reader.recordNum();
+        result->fBytesRead = result->fSize;
+        stats.fBytesRead = reader.size();
+        stats.fLinesRead = statusInfo.fLineNum;
+        result->fStatus = std::make_pair( true, QString() );
+    }
 
-        determineDependencies();
-        reportFunc( "Product Dir Usages:" );
-        for ( auto && ii : fProdDirUsages )
+    void CBuildInfoData::loadExecJournal( SLogResult * result, const std::atomic< bool > & canceled ) const
+    {
+        CExecJournalReader reader( result->fFileName );
+        if ( !reader.open() )
         {
-            reportFunc( ii );
+            result->fStatus = std::make_pair( false, reader.errorString() );
+            return;
         }
-        reportFunc( "================" );
-        reportFunc( statusInfo.getStatusString( fDirectories.size(), false ) );
-        fStatus = std::make_pair( true, QString() );
+
+        auto && statusInfo = result->fStatusInfo;
+        auto && stats = result->fStats;
+        SExecJournalEntry entry;
+        while ( true )
+        {
+            {
+                CStageTimer readTimer( stats, SBuildLoadStats::eRead );
+                if ( !reader.readEntry( entry ) )
+                    break;
+            }
+            if ( canceled )
+                return;
+
+            // every program of the build is in the journal, shells and the compiler internals are not worth a message
+            statusInfo.fLineNum++;
+            result->fDirStack = QStringList() << entry.fWorkingDir;
+            auto item = loadItem( entry.commandLine(), *result, false );
+            if ( item )
+                result->fItems.push_back( item );
+        }
+        result->fBytesRead = result->fSize;
+        stats.fBytesRead = reader.size();
+        stats.fLinesRead = statusInfo.fLineNum;
+        result->fStatus = std::make_pair( true, QString() );
     }
 
-    bool CBuildInfoData::isSourceFile( const QString & fileName ) const
+    std::shared_ptr< SItem > CBuildInfoData::loadItem( const QString & line, SLogResult & result, bool reportUnhandled ) const
     {
-        static std::map< QString, bool > suffixes;
-        QFileInfo fi( fileName );
-        auto suffix = fi.completeSuffix().toLower();
-        auto pos = suffixes.find( suffix );
-        if ( pos != suffixes.end() )
-            return ( *pos ).second;
+        auto && statusInfo = result.fStatusInfo;
+        auto && stats = result.fStats;
+
+        // matching is what is left of the time once the decoding and ProdDir rewriting nested in it are removed
+        auto nestedBefore = stats.fStageNSecs[ SBuildLoadStats::eDecode ] + stats.fStageNSecs[ SBuildLoadStats::eProdDir ];
+        CStageTimer matchTimer( stats, SBuildLoadStats::eMatch );
+
+        // incremental and retried builds repeat the same commands, only the first one is parsed
+        auto fingerprint = commandFingerprint( line, result.fDirStack.isEmpty() ? QString() : result.fDirStack.back() );
+        auto pos = result.fFingerprints.find( fingerprint );
+        if ( pos != result.fFingerprints.end() )
+        {
+            result.fLastCompileItem.reset();
+            statusInfo.fNumRepeats++;
+            ( *pos ).second->fRepeats++;
+            return nullptr;
+        }
+
+        std::shared_ptr< SItem > item;
+        if ( ( item = loadVSCl( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumCL++;
+        else if ( ( item = loadGcc( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumGcc++;
+        else if ( ( item = loadLibrary( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumLib++;
+        else if ( ( item = loadLink( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumLink++;
+        else if ( ( item = loadManifest( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumManifest++;
+        else if ( loadCygwinCC( line, statusInfo.fLineNum ) )
+            statusInfo.fNumCygwinCC++;
+        else if ( ( item = loadObfuscate( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumObfuscate++;
+        else if ( ( item = loadMoc( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumMoc++;
+        else if ( ( item = loadUic( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumUIC++;
+        else if ( ( item = loadRcc( line, statusInfo.fLineNum, result ) ) )
+            statusInfo.fNumRcc++;
+        else
+        {
+            statusInfo.fNumUnloaded++;
+            if ( reportUnhandled )
+                result.fMessages << QString( "ERROR: LineNum: %1 Could not load line: %2" ).arg( statusInfo.fLineNum ).arg( line );
+        }
+        if ( matchTimer.stop() )
+            stats.fStageNSecs[ SBuildLoadStats::eMatch ] -= stats.fStageNSecs[ SBuildLoadStats::eDecode ] + stats.fStageNSecs[ SBuildLoadStats::eProdDir ] - nestedBefore;
 
-        bool retVal = false;
-        if ( ( suffix == "c" ) || ( suffix == "obf.c" ) || ( suffix == "sdf.c" ) )
-            retVal = true;
-        else if ( suffix == "cpp" )
-            retVal = true;
-        else if ( suffix == "cxx" )
-            retVal = true;
-        else if ( suffix == "h" )
-            retVal = true;
-
-        if ( fi.fileName().startsWith( "moc_" ) && suffix == "pic.cxx" )
+        // a line that loaded nothing is checked again each time, so every copy of it is counted and reported
+        if ( item )
+        {
+            item->fFingerprint = fingerprint;
+            result.fFingerprints[ fingerprint ] = item;
+        }
+        result.fLastCompileItem = std::dynamic_pointer_cast< SCompileItem >( item );
+        return item;
+    }
+
+    // cl /showIncludes prints "Note: including file:" and one more space per nesting level, MSBuild may prefix the node number
+    bool CBuildInfoData::loadShowInclude( const QString & line, SLogResult & result ) const
+    {
+        static const QString kNote = QStringLiteral( "Note: including file:" );
+        auto pos = line.indexOf( kNote );
+        if ( pos == -1 )
+            return false;
+
+        result.fStatusInfo.fNumShowIncludes++;
+        if ( !result.fLastCompileItem )
             return true;
 
-        suffixes[ suffix ] = retVal;
-        //for ( auto && ii : suffixes )
-        //    qDebug() << ii.first << " = " << ii.second;
+        pos += kNote.length();
+        int depth = 0;
+        while ( ( pos < line.length() ) && ( line[ pos ] == ' ' ) )
+        {
+            ++depth;
+            ++pos;
+        }
+        auto header = line.mid( pos ).trimmed();
+        if ( !header.isEmpty() )
+            result.fLastCompileItem->fShowIncludes.push_back( std::make_pair( depth, header ) );
+        return true;
+    }
+
+    quint64 CBuildInfoData::commandFingerprint( const QString & line, const QString & dir )
+    {
+        // 64 bit FNV-1a over the UTF-16 units, the line is already simplified so the whitespace is normalized
+        quint64 retVal = 14695981039346656037ULL;
+        auto hashString = [&retVal]( const QString & str )
+        {
+            auto data = str.utf16();
+            for ( int ii = 0; ii < str.length(); ++ii )
+            {
+                retVal ^= data[ ii ];
+                retVal *= 1099511628211ULL;
+            }
+        };
+        // relative paths mean something else in another directory
+        hashString( dir );
+        retVal ^= 0xffff;
+        retVal *= 1099511628211ULL;
+        hashString( line );
         return retVal;
     }
 
+    int CBuildInfoData::mergeLog( SLogResult * result )
+    {
+        int retVal = 0;
+        for ( auto && ii : result->fItems )
+        {
+            auto pos = fFingerprints.find( ii->fFingerprint );
+            if ( pos != fFingerprints.end() )
+            {
+                ( *pos ).second->fRepeats += 1 + ii->fRepeats;
+                retVal++;
+                continue;
+            }
+            fFingerprints[ ii->fFingerprint ] = ii;
+
+            ii->fItemID = static_cast< int >( fItems.size() );
+            ii->forEachPath( [this]( QString & path ) { path = internPath( path ); } );
+            fItems.push_back( ii );
+            addItem( ii );
+        }
+        fProdDirUsages.insert( result->fProdDirUsages.begin(), result->fProdDirUsages.end() );
+        return retVal;
+    }
+
+    QString CBuildInfoData::internPath( const QString & path )
+    {
+        auto pos = fPathPool.constFind( path );
+        if ( pos != fPathPool.constEnd() )
+            return *pos;
+        fPathPool.insert( path );
+        return path;
+    }
+
+    QString CBuildInfoData::itemLocation( const std::shared_ptr< SItem > & item ) const
+    {
+        if ( fLogFiles.count() < 2 )
+            return QString( "LineNumber: %1" ).arg( item->fLineNumber );
+        return QString( "LineNumber: %1 (%2)" ).arg( item->fLineNumber ).arg( QFileInfo( fLogFiles[ item->fLogIndex ] ).fileName() );
+    }
+
     void CBuildInfoData::cleanupProdDirUsages( QStringList & data )
     {
         for ( auto && ii : data )
@@ -168,16 +636,23 @@ namespace NVSProjectMaker
             for ( auto && jj : ii.second->allSources() )
             {
                 //qDebug() << "    " << jj;
-                if ( isSourceFile( jj ) )
+                std::shared_ptr< SItem > srcItem;
+                // a generator's inputs, .hpp and .hxx headers included, come from the source tree
+                if ( CFileClassifier::isBuildLogSourceFile( jj ) || std::dynamic_pointer_cast< SQtGeneratorItem >( ii.second ) )
+                {
+                    // only generated sources, moc_*.cpp, qrc_*.cpp and the like, are produced by an item
+                    auto pos = fTargets.find( jj );
+                    if ( pos != fTargets.end() )
+                        ii.second->fDependencyItems.push_back( ( *pos ).second );
                     continue;
+                }
                 auto pos = fSources.find( jj );
-                std::shared_ptr< SItem > srcItem;
                 if ( pos == fSources.end() )
                 {
                     pos = fTargets.find( jj );
                     if ( pos == fTargets.end() )
                     {
-                        fReportFunc( QString( "ERROR: LineNumber: %1 - Could not find source item: %2" ).arg( ii.second->fLineNumber ).arg( jj ) );
+                        fReportFunc( QString( "ERROR: %1 - Could not find source item: %2" ).arg( itemLocation( ii.second ) ).arg( jj ) );
                     }
                     else
                         srcItem = ( *pos ).second;
@@ -198,7 +673,7 @@ namespace NVSProjectMaker
             {
                 pos = fSources.find( target );
                 if ( pos == fSources.end() )
-                    fReportFunc( QString( "ERROR: LineNumber: %1 - Could not find target item: %2" ).arg( ii.second->fLineNumber ).arg( target ) );
+                    fReportFunc( QString( "ERROR: %1 - Could not find target item: %2" ).arg( itemLocation( ii.second ) ).arg( target ) );
                 else
                     tgtItem = ( *pos ).second;
             }
@@ -209,6 +684,99 @@ namespace NVSProjectMaker
         }
     }
 
+    CBuildInfoData::SStatusInfo & CBuildInfoData::SStatusInfo::operator+=( const SStatusInfo & rhs )
+    {
+        fLineNum += rhs.fLineNum;
+        fNumCL += rhs.fNumCL;
+        fNumGcc += rhs.fNumGcc;
+        fNumCygwinCC += rhs.fNumCygwinCC;
+        fNumLib += rhs.fNumLib;
+        fNumLink += rhs.fNumLink;
+        fNumManifest += rhs.fNumManifest;
+        fNumObfuscate += rhs.fNumObfuscate;
+        fNumMoc += rhs.fNumMoc;
+        fNumUIC += rhs.fNumUIC;
+        fNumRcc += rhs.fNumRcc;
+        fNumUnloaded += rhs.fNumUnloaded;
+        fNumRepeats += rhs.fNumRepeats;
+        fNumShowIncludes += rhs.fNumShowIncludes;
+        return *this;
+    }
+
+    QList< QPair< QString, int > > CBuildInfoData::SStatusInfo::linesPerTool() const
+    {
+        return QList< QPair< QString, int > >()
+            << qMakePair( QString( "CL" ), fNumCL )
+            << qMakePair( QString( "GCC" ), fNumGcc )
+            << qMakePair( QString( "Libs" ), fNumLib )
+            << qMakePair( QString( "Link" ), fNumLink )
+            << qMakePair( QString( "Manifests" ), fNumManifest )
+            << qMakePair( QString( "CygwinCC.pl" ), fNumCygwinCC )
+            << qMakePair( QString( "Obfuscated" ), fNumObfuscate )
+            << qMakePair( QString( "Moc" ), fNumMoc )
+            << qMakePair( QString( "Uic" ), fNumUIC )
+            << qMakePair( QString( "Rcc" ), fNumRcc )
+            << qMakePair( QString( "Unhandled" ), fNumUnloaded )
+            << qMakePair( QString( "Repeated" ), fNumRepeats )
+            << qMakePair( QString( "ShowIncludes" ), fNumShowIncludes )
+            ;
+    }
+
+    QString SBuildLoadStats::stageName( EStage stage )
+    {
+        switch ( stage )
+        {
+            case eRead: return "Read (thread time)";
+            case eMatch: return "Tool Matching (thread time)";
+            case eDecode: return "Option Decoding (thread time)";
+            case eProdDir: return "ProdDir Rewriting (thread time)";
+            case eLoad: return "Parallel Load";
+            case eMerge: return "Merge";
+            case eDependencies: return "Dependency Resolution";
+            case eTree: return "Tree Building";
+            case eNumStages:
+            default:
+                return QString();
+        }
+    }
+
+    SBuildLoadStats & SBuildLoadStats::operator+=( const SBuildLoadStats & rhs )
+    {
+        for ( size_t ii = 0; ii < fStageNSecs.size(); ++ii )
+            fStageNSecs[ ii ] += rhs.fStageNSecs[ ii ];
+        fBytesRead += rhs.fBytesRead;
+        fLinesRead += rhs.fLinesRead;
+        return *this;
+    }
+
+    QList< QPair< QString, QString > > SBuildLoadStats::rows() const
+    {
+        QList< QPair< QString, QString > > retVal;
+        if ( !fEnabled )
+            return retVal;
+
+        for ( int ii = 0; ii < eNumStages; ++ii )
+            retVal << qMakePair( stageName( static_cast< EStage >( ii ) ), QString( "%1 ms" ).arg( fStageNSecs[ ii ] / 1000000.0, 0, 'f', 3 ) );
+        retVal << qMakePair( QString( "Bytes Read" ), QString::number( fBytesRead ) );
+        retVal << qMakePair( QString( "Lines Read" ), QString::number( fLinesRead ) );
+        for ( auto && ii : fLinesPerTool )
+            retVal << qMakePair( QString( "Lines - %1" ).arg( ii.first ), QString::number( ii.second ) );
+        retVal << qMakePair( QString( "Items Allocated" ), QString::number( fItems ) );
+        retVal << qMakePair( QString( "Items with Options Decoded on Demand" ), QString::number( fLazyItems ) );
+        retVal << qMakePair( QString( "Unique Paths" ), QString::number( fUniquePaths ) );
+        retVal << qMakePair( QString( "Option Entries Allocated" ), QString::number( fOptionEntries ) );
+        retVal << qMakePair( QString( "Peak Options Set on an Item" ), QString::number( fPeakOptionCount ) );
+        return retVal;
+    }
+
+    QString SBuildLoadStats::getText() const
+    {
+        QStringList retVal;
+        for ( auto && ii : rows() )
+            retVal << QString( "%1: %2" ).arg( ii.first ).arg( ii.second );
+        return retVal.join( "\n" );
+    }
+
     QString CBuildInfoData::SStatusInfo::getStatusString( size_t numDirectories, bool forGUI ) const
     {
         QStringList data = QStringList()
@@ -224,6 +792,8 @@ namespace NVSProjectMaker
             << QString( "Uic: %1" ).arg( fNumUIC )
             << QString( "Rcc: %1" ).arg( fNumRcc )
             << QString( "Unhandled: %1" ).arg( fNumUnloaded )
+            << QString( "Repeated Commands Skipped: %1" ).arg( fNumRepeats )
+            << QString( "Include Notes: %1" ).arg( fNumShowIncludes )
             ;
         QString prefix;
         QString suffix;
@@ -242,7 +812,7 @@ namespace NVSProjectMaker
         return prefix + data.join( " " ) + suffix;
     }
 
-    std::shared_ptr< SItem > CBuildInfoData::loadLine( QRegularExpression & regExp, const QString & line, int lineNum, std::shared_ptr< SItem > item )
+    std::shared_ptr< SItem > CBuildInfoData::loadLine( QRegularExpression & regExp, const QString & line, int lineNum, std::shared_ptr< SItem > item, SLogResult & result ) const
     {
         QRegularExpressionMatch match;
         if ( line.indexOf( regExp, 0, &match ) != 0 )
@@ -251,130 +821,120 @@ namespace NVSProjectMaker
         if ( !item )
             return nullptr;
 
-        item->loadData( line, match.capturedLength() );
+        item->fLogIndex = result.fLogIndex;
+        CStageTimer decodeTimer( result.fStats, SBuildLoadStats::eDecode );
+        if ( fLazyOptions )
+            item->loadDataLazy( line, match.capturedLength() );
+        else
+            item->loadData( line, match.capturedLength() );
+        decodeTimer.stop();
         if ( !item->status() )
         {
-            fStatus = item->fStatus;
-            fReportFunc( QString( "Error LineNum: %1 - %2\n" ).arg( lineNum ).arg( item->errorString() ) );
+            result.fMessages << QString( "Error LineNum: %1 - %2\n" ).arg( lineNum ).arg( item->errorString() );
             return nullptr;
         }
 
-        auto tmp = item->postLoadData( lineNum, fSettings->getBldTxtProdDir(), fReportFunc );
+        if ( !result.fDirStack.isEmpty() )
+        {
+            // before the ProdDir rewriting, so it sees the absolute paths
+            auto currDir = QDir( result.fDirStack.back() );
+            item->forEachPath( [&currDir]( QString & path )
+            {
+                if ( !path.isEmpty() && QDir::isRelativePath( path ) )
+                    path = QDir::cleanPath( currDir.absoluteFilePath( path ) );
+            } );
+        }
+
+        CStageTimer prodDirTimer( result.fStats, SBuildLoadStats::eProdDir );
+        auto tmp = item->postLoadData( lineNum, fSettings->getBldTxtProdDir(), [&result]( const QString & msg ) { result.fMessages << msg; } );
         cleanupProdDirUsages( tmp );
-        fProdDirUsages.insert( tmp.begin(), tmp.end() );
+        result.fProdDirUsages.insert( tmp.begin(), tmp.end() );
         return item;
     }
 
-    bool CBuildInfoData::loadVSCl( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadVSCl( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/cl(.exe)?\\s+" );
         if ( line.indexOf( regExp, 0 ) != 0 )
-            return false;
-
-        auto item = std::dynamic_pointer_cast< SVSCLCompileItem >( loadLine( regExp, line, lineNum, std::make_shared< SVSCLCompileItem >( lineNum ) ) );
-        if ( !item )
-            return false;
+            return nullptr;
 
-        addItem( item );
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SVSCLCompileItem >( lineNum, fLazyOptions ), result );
     }
 
-    bool CBuildInfoData::loadGcc( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadGcc( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/(gcc|g++)(.exe)?\\s+" );
         if ( line.indexOf( regExp, 0 ) != 0 )
-            return false;
-
-        auto item = std::dynamic_pointer_cast<SGccCompileItem>( loadLine( regExp, line, lineNum, std::make_shared< SGccCompileItem >( lineNum ) ) );
-        if ( !item )
-            return false;
+            return nullptr;
 
-        addItem( item );
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SGccCompileItem >( lineNum, fLazyOptions ), result );
     }
 
-    bool CBuildInfoData::loadLibrary( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadLibrary( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/lib(.exe)?\\s+" );
         if ( line.indexOf( regExp, 0 ) != 0 )
-            return false;
-
-        auto item = std::dynamic_pointer_cast<SLibraryItem>( loadLine( regExp, line, lineNum, std::make_shared< SLibraryItem >( lineNum ) ) );
-        if ( !item )
-            return false;
+            return nullptr;
 
-        addItem( item );
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SLibraryItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadLink( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadLink( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/link(.exe)?\\s+" );
         if ( line.indexOf( regExp, 0 ) != 0 )
-            return false;
-
-        auto item = std::dynamic_pointer_cast<SExecItem>( loadLine( regExp, line, lineNum, std::make_shared< SExecItem >( lineNum ) ) );
-        if ( !item )
-            return false;
-
-        //qDebug() << item->targetFile();
-        //qDebug() << item->srcDir();
-        //qDebug() << item->targetDir();
-        //qDebug() << item->dirForItem();
+            return nullptr;
 
-        addItem( item );
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SExecItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadManifest( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadManifest( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/mt(.exe)?\\s+" );
         if ( line.indexOf( regExp, 0 ) != 0 )
-            return false;
-
-        auto item = std::dynamic_pointer_cast<SManifestItem>( loadLine( regExp, line, lineNum, std::make_shared< SManifestItem >( lineNum ) ) );
-        if ( !item )
-            return false;
+            return nullptr;
 
-        addItem( item );
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SManifestItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadCygwinCC( const QString & line, int /*lineNum*/ )
+    bool CBuildInfoData::loadCygwinCC( const QString & line, int /*lineNum*/ ) const
     {
         auto regExp = QRegularExpression( "^.*\\/perl(.exe)?\\s+.*cygwin_cc.pl\\s+" );
         QRegularExpressionMatch match;
         return line.indexOf( regExp, 0, &match ) == 0;
     }
 
-    bool CBuildInfoData::loadObfuscate( const QString & line, int lineNum )
+    std::shared_ptr< SItem > CBuildInfoData::loadObfuscate( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/mtiObfuscate.pl\\s+" );
-        auto item = std::dynamic_pointer_cast<SObfuscatedItem>( loadLine( regExp, line, lineNum, std::make_shared< SObfuscatedItem >( lineNum ) ) );
-        if ( !item )
-            return false;
-
-        addItem( item );
-
-        return true;
+        return loadLine( regExp, line, lineNum, std::make_shared< SObfuscatedItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadMoc( const QString & line, int /*lineNum*/ )
+    std::shared_ptr< SItem > CBuildInfoData::loadMoc( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/moc(.exe)?\\s+" );
-        return line.indexOf(regExp, 0) == 0;
+        if ( line.indexOf( regExp, 0 ) != 0 )
+            return nullptr;
+
+        return loadLine( regExp, line, lineNum, std::make_shared< SMocItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadUic(const QString & line, int /*lineNum*/)
+    std::shared_ptr< SItem > CBuildInfoData::loadUic( const QString & line, int lineNum, SLogResult & result ) const
     {
         auto regExp = QRegularExpression( "^.*\\/uic(.exe)?\\s+" );
-        return line.indexOf(regExp, 0) == 0;
+        if ( line.indexOf( regExp, 0 ) != 0 )
+            return nullptr;
+
+        return loadLine( regExp, line, lineNum, std::make_shared< SUicItem >( lineNum ), result );
     }
 
-    bool CBuildInfoData::loadRcc(const QString & line, int /*lineNum*/)
+    std::shared_ptr< SItem > CBuildInfoData::loadRcc( const QString & line, int lineNum, SLogResult & result ) const
     {
-        auto regExp = QRegularExpression("^.*\\/rcc(.exe)?\\s+");
-        return line.indexOf(regExp, 0) == 0;
+        auto regExp = QRegularExpression( "^.*\\/rcc(.exe)?\\s+" );
+        if ( line.indexOf( regExp, 0 ) != 0 )
+            return nullptr;
+
+        return loadLine( regExp, line, lineNum, std::make_shared< SRccItem >( lineNum ), result );
     }
 
     void CBuildInfoData::addItem( std::shared_ptr< SItem > item )
@@ -396,12 +956,20 @@ namespace NVSProjectMaker
             outDirItem->fManifests.push_back( std::dynamic_pointer_cast<SManifestItem>( item ) );
         else if ( std::dynamic_pointer_cast<SObfuscatedItem>( item ) )
             outDirItem->fObfuscatedItems.push_back( std::dynamic_pointer_cast<SObfuscatedItem>( item ) );
+        else if ( std::dynamic_pointer_cast<SQtGeneratorItem>( item ) )
+            outDirItem->fGeneratorItems.push_back( std::dynamic_pointer_cast<SQtGeneratorItem>( item ) );
 
         if ( !std::dynamic_pointer_cast<SManifestItem>( item ) )
         {
             auto tgtFile = item->targetFile();
             if ( !tgtFile.isEmpty() )
+            {
+                // identical commands were dropped while loading, so a second item for the target means a second recipe
+                auto pos = fTargets.find( tgtFile );
+                if ( ( pos != fTargets.end() ) && ( ( *pos ).second->fFingerprint != item->fFingerprint ) )
+                    fReportFunc( QString( "WARNING: '%1' is built by different commands, %2 and %3" ).arg( tgtFile ).arg( itemLocation( ( *pos ).second ) ).arg( itemLocation( item ) ) );
                 fTargets.insert( std::make_pair( tgtFile, item ) );
+            }
         }
         if ( !std::dynamic_pointer_cast<SCompileItem>( item ) )
         {
@@ -515,6 +1083,12 @@ namespace NVSProjectMaker
         return retVal;
     }
 
+    void SManifestItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        forEachOptionPath( "outputresource", func );
+        forEachOptionPath( "manifest", func );
+    }
+
     SObfuscatedItem::SObfuscatedItem( int lineNum ) :
         SItem( lineNum, Qt::CaseSensitivity::CaseInsensitive )
     {
@@ -562,6 +1136,261 @@ namespace NVSProjectMaker
         return retVal;
     }
 
+    void SObfuscatedItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        SItem::forEachPath( func );
+        func( fInputFile );
+    }
+
+    SQtGeneratorItem::SQtGeneratorItem( int lineNum ) :
+        SItem( lineNum, Qt::CaseSensitivity::CaseSensitive )
+    {
+    }
+
+    bool SQtGeneratorItem::loadData( const QString & line, int pos )
+    {
+        return loadLine( line, pos,
+                         [this]( const QString & nonOptLine )
+        {
+            auto prevOption = canonicalOption( fPrevOption );
+            if ( !fPrevOption.isEmpty() && valueOptions().contains( prevOption ) )
+            {
+                addOptionValue( prevOption, nonOptLine );
+                fPrevOption.clear();
+            }
+            else
+                fInputFiles << nonOptLine;
+        }
+        );
+    }
+
+    QString SQtGeneratorItem::resolveOption( const TOptionTypeMap & options, const QString & option, QString & remainder ) const
+    {
+        auto pos = optionAliases().find( option.mid( 1 ) );
+        if ( pos == optionAliases().end() )
+            return SItem::resolveOption( options, option, remainder );
+
+        remainder.clear();
+        return ( *pos ).second;
+    }
+
+    QString SQtGeneratorItem::canonicalOption( const QString & optName ) const
+    {
+        auto pos = optionAliases().find( optName );
+        return ( pos == optionAliases().end() ) ? optName : ( *pos ).second;
+    }
+
+    // the option itself was loaded with an empty value, the next argument replaces it
+    void SQtGeneratorItem::addOptionValue( const QString & optName, const QString & value )
+    {
+        auto pos = fOptions.find( optName );
+        if ( pos == fOptions.end() )
+        {
+            // the option itself went to fOtherOptions, keep its value with it
+            if ( !fOtherOptions.isEmpty() )
+                fOtherOptions.back() += " " + value;
+            return;
+        }
+
+        auto && currValue = std::get< 2 >( ( *pos ).second );
+        switch ( std::get< 0 >( ( *pos ).second ) )
+        {
+            case EOptionType::eBool:
+                break;
+            case EOptionType::eString:
+                currValue = std::make_tuple( false, value, QStringList() );
+                break;
+            case EOptionType::eStringList:
+                if ( !currValue.has_value() )
+                    currValue = std::make_tuple( false, QString(), QStringList() << value );
+                else if ( !std::get< 2 >( currValue.value() ).isEmpty() && std::get< 2 >( currValue.value() ).back().isEmpty() )
+                    std::get< 2 >( currValue.value() ).back() = value;
+                else
+                    std::get< 2 >( currValue.value() ) << value;
+                break;
+        }
+    }
+
+    QStringList SQtGeneratorItem::allSources() const
+    {
+        return fInputFiles;
+    }
+
+    QStringList SQtGeneratorItem::xformProdDirInSourceAndTarget( const QString & origProdDir )
+    {
+        return transformProdDir( fInputFiles, origProdDir );
+    }
+
+    void SQtGeneratorItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        SItem::forEachPath( func );
+        for ( auto && ii : fInputFiles )
+            func( ii );
+    }
+
+    void SMocItem::initOptions()
+    {
+        fOptions =
+        {
+             {"o", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"I", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"F", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"D", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"U", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"M", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"E", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"i", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"p", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"f", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) } // -f[<file>], the value is never the next argument
+            ,{"b", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"nn", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"nw", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-include", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"-compiler-flavor", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-no-notes", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-no-warnings", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-ignore-option-clashes", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-output-json", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-collect-json", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-output-dep-file", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-dep-file-path", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-dep-file-rule-name", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+        };
+    }
+
+    const QStringList & SMocItem::valueOptions() const
+    {
+        static const QStringList sOptions = { "o", "I", "F", "D", "U", "M", "p", "b", "-include", "-compiler-flavor", "-dep-file-path", "-dep-file-rule-name" };
+        return sOptions;
+    }
+
+    const std::map< QString, QString > & SMocItem::optionAliases() const
+    {
+        static const std::map< QString, QString > sAliases = { { "-output", "o" }, { "include", "-include" } };
+        return sAliases;
+    }
+
+    void SUicItem::initOptions()
+    {
+        fOptions =
+        {
+             {"o", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"a", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"p", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"n", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"s", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"d", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"g", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"c", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"tr", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-postfix", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-include", std::make_tuple( EOptionType::eStringList, false, TOptionValue() ) }
+            ,{"-idbased", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-from-imports", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-star-imports", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-rc-prefix", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+        };
+    }
+
+    const QStringList & SUicItem::valueOptions() const
+    {
+        static const QStringList sOptions = { "o", "g", "c", "tr", "-postfix", "-include" };
+        return sOptions;
+    }
+
+    const std::map< QString, QString > & SUicItem::optionAliases() const
+    {
+        static const std::map< QString, QString > sAliases =
+        {
+             { "-output", "o" }
+            ,{ "-no-autoconnection", "a" }
+            ,{ "-no-protection", "p" }
+            ,{ "-no-implicit-includes", "n" }
+            ,{ "-no-stringliteral", "s" }
+            ,{ "-dependencies", "d" }
+            ,{ "-generator", "g" }
+            ,{ "-connections", "c" }
+            ,{ "-tr", "tr" }
+            ,{ "-translate", "tr" }
+        };
+        return sAliases;
+    }
+
+    void SRccItem::initOptions()
+    {
+        fOptions =
+        {
+             {"o", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"t", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"d", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"g", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-name", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-root", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-compress", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-compress-algo", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-no-compress", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-no-zstd", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-threshold", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-binary", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-pass", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+            ,{"-namespace", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-no-namespace", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-verbose", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-list", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-list-mapping", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-project", std::make_tuple( EOptionType::eBool, false, TOptionValue() ) }
+            ,{"-format-version", std::make_tuple( EOptionType::eString, false, TOptionValue() ) }
+        };
+    }
+
+    const QStringList & SRccItem::valueOptions() const
+    {
+        static const QStringList sOptions = { "o", "t", "d", "g", "-name", "-root", "-compress", "-compress-algo", "-threshold", "-pass", "-format-version" };
+        return sOptions;
+    }
+
+    // rcc also takes its long options with a single '-'
+    const std::map< QString, QString > & SRccItem::optionAliases() const
+    {
+        static const std::map< QString, QString > sAliases =
+        {
+             { "-output", "o" }
+            ,{ "-temp", "t" }
+            ,{ "-depfile", "d" }
+            ,{ "-generator", "g" }
+            ,{ "name", "-name" }
+            ,{ "root", "-root" }
+            ,{ "compress", "-compress" }
+            ,{ "compress-algo", "-compress-algo" }
+            ,{ "no-compress", "-no-compress" }
+            ,{ "threshold", "-threshold" }
+            ,{ "binary", "-binary" }
+            ,{ "pass", "-pass" }
+            ,{ "namespace", "-namespace" }
+            ,{ "no-namespace", "-no-namespace" }
+            ,{ "verbose", "-verbose" }
+            ,{ "list", "-list" }
+            ,{ "list-mapping", "-list-mapping" }
+            ,{ "project", "-project" }
+            ,{ "format-version", "-format-version" }
+        };
+        return sAliases;
+    }
+
+    QStringList CBuildInfoData::generatedFiles() const
+    {
+        QStringList retVal;
+        for ( auto && ii : fItems )
+        {
+            if ( !std::dynamic_pointer_cast< SQtGeneratorItem >( ii ) )
+                continue;
+            auto target = ii->targetFile();
+            if ( !target.isEmpty() )
+                retVal << target;
+        }
+        return retVal;
+    }
+
     std::shared_ptr< NVSProjectMaker::SDirItem > CBuildInfoData::addDir( const QString & dir )
     {
         auto pos = fDirectories.find( dir );
@@ -572,10 +1401,17 @@ namespace NVSProjectMaker
         return retVal;
     }
 
-    SVSCLCompileItem::SVSCLCompileItem( int lineNum ) :
-        SCompileItem( lineNum )
+    SVSCLCompileItem::SVSCLCompileItem( int lineNum, bool lazyOptions ) :
+        SCompileItem( lineNum, lazyOptions )
     {
-        initOptions();
+        if ( !fLazy )
+            initOptions();
+    }
+
+    const TOptionTypeMap & SVSCLCompileItem::prototypeOptions() const
+    {
+        static const TOptionTypeMap sOptions = SVSCLCompileItem( -1 ).fOptions;
+        return sOptions;
     }
 
     bool SVSCLCompileItem::loadData( const QString & line, int pos )
@@ -834,10 +1670,125 @@ namespace NVSProjectMaker
         return transformProdDir( fSourceFiles, origProdDir );
     }
 
-    SGccCompileItem::SGccCompileItem( int lineNum ) :
-        SCompileItem( lineNum )
+    bool SCompileItem::loadDataLazy( const QString & line, int pos )
     {
+        if ( !fLazy )
+            return loadData( line, pos );
+
+        fRawLine = line;
+        fRawPos = pos;
+
+        // only the object file and the sources are pulled out, using the same option matching as loadLine.
+        // The checks loadLine makes on the way are cheap, so conflicting values still reject the item,
+        // and the unknown options are kept for the warnings postLoadData reports
+        auto && options = prototypeOptions();
+        std::map< QString, QString > singleValues;
+        QString prevOption;
+        auto tokens = line.mid( pos ).split( ' ', Qt::SkipEmptyParts );
+        for ( auto && ii : tokens )
+        {
+            if ( ii.startsWith( "-" ) || ii.startsWith( "/" ) )
+            {
+                prevOption = ii.mid( 1 );
+                QString remainder;
+                auto optName = resolveOption( options, ii, remainder );
+                auto optPos = optName.isEmpty() ? options.end() : options.find( optName );
+                if ( optPos == options.end() )
+                {
+                    fOtherOptions << ii;
+                    continue;
+                }
+
+                if ( optName == targetFileOption() )
+                    fLazyTargetFile = remainder;
+
+                auto optType = std::get< 0 >( ( *optPos ).second );
+                if ( optType == EOptionType::eStringList )
+                    continue;
+
+                auto value = ( optType == EOptionType::eBool ) ? QString( isTrue( remainder ) ? "True" : "False" ) : remainder;
+                auto prevValue = singleValues.find( optName );
+                if ( prevValue == singleValues.end() )
+                    singleValues[ optName ] = value;
+                else if ( ( *prevValue ).second != value )
+                {
+                    fStatus = std::make_pair( false, QString( "Option: %1 already set to %2" ).arg( optName ).arg( ( *prevValue ).second ) );
+                    return false;
+                }
+            }
+            else if ( ii == ">" )
+                prevOption = ">";
+            else if ( targetFollowsOption( prevOption ) )
+            {
+                fLazyTargetFile = ii;
+                prevOption.clear();
+            }
+            else
+                fSourceFiles << ii;
+        }
+
+        fStatus = std::make_pair( true, QString() );
+        return true;
+    }
+
+    QStringList SCompileItem::rawOptionValues() const
+    {
+        QStringList retVal;
+        auto && options = prototypeOptions();
+        auto tokens = fRawLine.mid( fRawPos ).split( ' ', Qt::SkipEmptyParts );
+        for ( auto && ii : tokens )
+        {
+            if ( !ii.startsWith( "-" ) && !ii.startsWith( "/" ) )
+                continue;
+
+            QString remainder;
+            auto optName = resolveOption( options, ii, remainder );
+            auto optPos = optName.isEmpty() ? options.end() : options.find( optName );
+            if ( ( optPos == options.end() ) || ( optName == targetFileOption() ) || ( std::get< 0 >( ( *optPos ).second ) == EOptionType::eBool ) )
+                continue;
+            retVal << remainder;
+        }
+        return retVal;
+    }
+
+    void SCompileItem::decodeRawLine()
+    {
+        // the sources and target may have been rewritten since the load (ProdDir, interning), keep them,
+        // the unknown options were found, and rewritten, at load
+        auto sourceFiles = fSourceFiles;
+        auto otherOptions = fOtherOptions;
         initOptions();
+        loadData( fRawLine, fRawPos );
+        fSourceFiles = sourceFiles;
+        fOtherOptions = otherOptions;
+
+        transformProdDir( fOptions, fOrigProdDir );
+
+        auto pos = fOptions.find( targetFileOption() );
+        if ( pos != fOptions.end() )
+            std::get< 2 >( ( *pos ).second ) = std::make_tuple( false, fLazyTargetFile, QStringList() );
+    }
+
+    void SCompileItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        SItem::forEachPath( func );
+        for ( auto && ii : fSourceFiles )
+            func( ii );
+        for ( auto && ii : fShowIncludes )
+            func( ii.second );
+    }
+
+    SGccCompileItem::SGccCompileItem( int lineNum, bool lazyOptions ) :
+        SCompileItem( lineNum, lazyOptions )
+    {
+        if ( !fLazy )
+            initOptions();
+    }
+
+    const TOptionTypeMap & SGccCompileItem::prototypeOptions() const
+    {
+        static const TOptionTypeMap sOptions = SGccCompileItem( -1 ).fOptions;
+        return sOptions;
     }
 
     bool SGccCompileItem::loadData( const QString & line, int pos )
@@ -928,6 +1879,14 @@ namespace NVSProjectMaker
         return transformProdDir( fInputs, origProdDir );
     }
 
+    void SLibraryItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        SItem::forEachPath( func );
+        forEachOptionPath( "DEF", func );
+        for ( auto && ii : fInputs )
+            func( ii );
+    }
+
     SExecItem::SExecItem( int lineNum ) :
         SItem( lineNum, Qt::CaseSensitivity::CaseInsensitive )
     {
@@ -1066,6 +2025,15 @@ namespace NVSProjectMaker
         return retVal;
     }
 
+    void SExecItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        SItem::forEachPath( func );
+        for ( auto && ii : fFiles )
+            func( ii );
+        for ( auto && ii : fCommandFiles )
+            func( ii );
+    }
+
     bool SItem::isTrue( const QString & value )
     {
         if ( value.isEmpty() )
@@ -1141,6 +2109,19 @@ namespace NVSProjectMaker
             << transformProdDir( fOptions, origProdDir )
         ;
 
+        if ( fLazy )
+        {
+            // the rest of the options get rewritten when they are decoded, their usages are
+            // reported now from a copy of their values, as the eager load does
+            fOrigProdDir = origProdDir;
+            retVal << transformProdDir( fLazyTargetFile, origProdDir );
+            if ( fRawLine.contains( origProdDir ) )
+            {
+                auto values = rawOptionValues();
+                retVal << transformProdDir( values, origProdDir );
+            }
+        }
+
         for ( auto && ii : fOtherOptions )
         {
             reportFunc( QString( "Warning LineNum: %1 - Unknown Options: %2\n" ).arg( lineNum ).arg( fOtherOptions.join( " " ) ) );
@@ -1158,6 +2139,44 @@ namespace NVSProjectMaker
         return retVal;
     }
 
+    void SItem::forEachPath( const std::function< void( QString & path ) > & func )
+    {
+        if ( !fLazy )
+        {
+            forEachOptionPath( targetFileOption(), func );
+            return;
+        }
+
+        func( fLazyTargetFile );
+        auto pos = fOptions.find( targetFileOption() );
+        if ( ( pos != fOptions.end() ) && std::get< 2 >( ( *pos ).second ).has_value() )
+            std::get< 1 >( std::get< 2 >( ( *pos ).second ).value() ) = fLazyTargetFile;
+    }
+
+    void SItem::forEachOptionPath( const QString & optName, const std::function< void( QString & path ) > & func )
+    {
+        auto pos = fOptions.find( optName );
+        if ( pos == fOptions.end() )
+            return;
+
+        auto && currValue = std::get< 2 >( ( *pos ).second );
+        if ( !currValue.has_value() )
+            return;
+
+        switch ( std::get< 0 >( ( *pos ).second ) )
+        {
+            case EOptionType::eBool:
+                break;
+            case EOptionType::eString:
+                func( std::get< 1 >( currValue.value() ) );
+                break;
+            case EOptionType::eStringList:
+                for ( auto && ii : std::get< 2 >( currValue.value() ) )
+                    func( ii );
+                break;
+        }
+    }
+
     QString SItem::dump() const
     {
         QString retVal = QString( "%1: LineNum:%2 - %3" ).arg( getItemTypeName() ).arg( fLineNumber ).arg( targetFile() );
@@ -1172,6 +2191,31 @@ namespace NVSProjectMaker
 
     }
 
+    QString SItem::resolveOption( const TOptionTypeMap & options, const QString & option, QString & remainder ) const
+    {
+        auto currOption = option.mid( 1 );
+        auto colonPos = currOption.indexOf( ':' );
+        remainder = ( colonPos != -1 ) ? currOption.mid( colonPos + 1 ) : QString();
+        currOption = ( colonPos != -1 ) ? currOption.left( colonPos ) : currOption;
+
+        auto pos = options.find( currOption );
+        if ( pos != options.end() )
+            return ( *pos ).first;
+
+        QString retVal;
+        for ( auto && ii : options )
+        {
+            if ( std::get< 1 >( ii.second ) ) // colon required dont look here
+                continue;
+            if ( ( ii.first.length() > retVal.length() ) && currOption.startsWith( ii.first, caseInsensitiveOptions() ) )
+                retVal = ii.first;
+        }
+
+        if ( !retVal.isEmpty() )
+            remainder = currOption.mid( retVal.length() );
+        return retVal;
+    }
+
     bool SItem::loadLine( const QString & line, int pos, std::function< void( const QString & noOpt ) > noOptFunc )
     {
         fPrevOption.clear();
@@ -1181,53 +2225,12 @@ namespace NVSProjectMaker
         while ( ( prevPos != -1 ) && ( prevPos < line.length() ) )
         {
             auto currOption = line.mid( prevPos, ( pos == -1 ) ? -1 : ( pos - prevPos ) );
-            bool isOpt = currOption.startsWith( "-" ) || currOption.startsWith( "/" );
-            if ( isOpt )
+            if ( isOptionToken( currOption ) )
             {
-                auto origOption = currOption;
-                currOption = currOption.mid( 1 );
-                fPrevOption = currOption;
-                auto colonPos = currOption.indexOf( ':' );
-                auto remainder = ( colonPos != -1 ) ? currOption.mid( colonPos + 1 ) : QString();
-                currOption = ( colonPos != -1 ) ? currOption.left( colonPos ) : currOption;
-                
-                auto pos = fOptions.find( currOption );
-                if ( pos == fOptions.end() )
-                {
-                    std::list< std::pair< QString, TOptionType > > possibleOptions;
-
-                    for ( auto && ii = fOptions.begin(); ii != fOptions.end(); ++ii )
-                    {
-                        if ( std::get< 1 >( ( *ii ).second ) ) // colon required dont look here
-                            continue;
-                        if ( currOption.startsWith( ( *ii ).first, caseInsensitiveOptions() ) )
-                        {
-                            possibleOptions.push_back( *ii );
-                        }
-                    }
-
-                    if ( possibleOptions.empty() )
-                    {
-                        fOtherOptions << origOption;
-                        continue;
-                    }
-
-                    std::pair< QString, TOptionType > bestOption;
-                    int max = 0;
-                    for ( auto && ii : possibleOptions )
-                    {
-                        if ( ii.first.length() > max )
-                        {
-                            bestOption = ii;
-                            max = ii.first.length();
-                        }
-                    }
-
-                    pos = fOptions.find( bestOption.first );
-                    remainder = currOption.mid( bestOption.first.length() );
-                    currOption = bestOption.first;
-                }
-
+                fPrevOption = currOption.mid( 1 );
+                QString remainder;
+                auto optName = resolveOption( fOptions, currOption, remainder );
+                auto pos = optName.isEmpty() ? fOptions.end() : fOptions.find( optName );
                 if ( pos != fOptions.end() )
                 {
                     switch ( std::get< 0 >( ( *pos ).second ) )
@@ -1240,7 +2243,7 @@ namespace NVSProjectMaker
                                 auto existingValue = std::get< 0 >( std::get< 2 >( ( *pos ).second ).value() );
                                 if ( newValue != existingValue )
                                 {
-                                    fStatus = std::make_pair( false, QString( "Option: %1 already set to %2" ).arg( currOption ).arg( existingValue ? "True" : "False" ) );
+                                    fStatus = std::make_pair( false, QString( "Option: %1 already set to %2" ).arg( optName ).arg( existingValue ? "True" : "False" ) );
                                     return false;
                                 }
                             }
@@ -1256,7 +2259,7 @@ namespace NVSProjectMaker
                                 auto existingValue = std::get< 1 >( std::get< 2 >( ( *pos ).second ).value() );
                                 if ( newValue != existingValue )
                                 {
-                                    fStatus = std::make_pair( false, QString( "Option: %1 already set to %2" ).arg( currOption ).arg( existingValue ) );
+                                    fStatus = std::make_pair( false, QString( "Option: %1 already set to %2" ).arg( optName ).arg( existingValue ) );
                                     return false;
                                 }
                             }
@@ -1280,7 +2283,7 @@ namespace NVSProjectMaker
                     }
                 }
                 else
-                    fOtherOptions << origOption;
+                    fOtherOptions << currOption;
             }
             else if ( currOption == ">" )
             {
@@ -1300,8 +2303,18 @@ namespace NVSProjectMaker
         return true;
     }
 
+    void SItem::decodeOptions() const
+    {
+        if ( !fLazy )
+            return;
+
+        std::call_once( fDecodeOnce, [this]() { const_cast< SItem * >( this )->decodeRawLine(); } );
+    }
+
     QString SItem::targetFile() const
     {
+        if ( fLazy )
+            return fLazyTargetFile;
         auto pos = fOptions.find( targetFileOption() );
         if ( pos == fOptions.end() )
             return QString();
@@ -1376,6 +2389,11 @@ namespace NVSProjectMaker
             folder->appendRow( QList< QStandardItem * >() << tgtItem );
         }
 
+        if ( fDurationMS >= 0 )
+            currRow.front()->appendRow( QList< QStandardItem * >() << new QStandardItem( QString( "Duration: %1 ms" ).arg( fDurationMS ) ) );
+        if ( fRepeats > 0 )
+            currRow.front()->appendRow( QList< QStandardItem * >() << new QStandardItem( QString( "Repeated: %1 times" ).arg( fRepeats ) ) );
+
         auto allSources = this->allSources();
         if ( !allSources.isEmpty() )
         {
@@ -1417,6 +2435,10 @@ namespace NVSProjectMaker
         {
             ii->loadIntoTree( dir );
         }
+        for ( auto && ii : fGeneratorItems )
+        {
+            ii->loadIntoTree( dir );
+        }
         return retVal;
     }
 
@@ -1424,6 +2446,7 @@ namespace NVSProjectMaker
     {
         if ( !model )
             return;
+        CStageTimer treeTimer( fStats, SBuildLoadStats::eTree );
         model->clear();
         model->setHorizontalHeaderLabels( QStringList() << "Source Directory" << "Target Directory" << "Type" << "Primary Input File" << "Output File" );
         if ( !fStatus.first )
@@ -24,14 +24,22 @@
 #define __BUILDINFODATA_H
 
 #include "SABUtils/StringComparisonClasses.h"
+#include "MakeDryRun.h"
 
 #include <QString>
 #include <QStringList>
+#include <QSet>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <map>
 #include <optional>
 #include <set>
+#include <unordered_map>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <vector>
 
 using TStringSet = std::set< QString >;
 
@@ -74,7 +82,17 @@ namespace NVSProjectMaker
 
         virtual void initOptions() = 0;
         virtual bool loadData( const QString & line, int pos ) = 0;
+        // only keeps what is needed to group the item, the options are decoded the first time they are asked for
+        virtual bool loadDataLazy( const QString & line, int pos ) { return loadData( line, pos ); }
         bool loadLine( const QString & line, int pos, std::function< void( const QString & nonOptLine ) > noOptFunc );
+        virtual bool isOptionToken( const QString & token ) const { return token.startsWith( "-" ) || token.startsWith( "/" ); }
+        virtual QString resolveOption( const TOptionTypeMap & options, const QString & option, QString & remainder ) const;
+
+        bool isLazy() const { return fLazy; }
+        void decodeOptions() const;
+        virtual void decodeRawLine() {}
+        virtual QStringList rawOptionValues() const { return {}; } // the values of the options a lazy item has not decoded
+        const TOptionTypeMap & options() const { decodeOptions(); return fOptions; }
 
         virtual QString targetFileOption() const = 0;
         virtual QString targetFile() const;
@@ -87,6 +105,7 @@ namespace NVSProjectMaker
 
         TOptionValue getOptionValue( const QString & optName ) const
         {
+            decodeOptions();
             auto pos = fOptions.find( optName );
             if ( pos == fOptions.end() )
                 return TOptionValue();
@@ -159,11 +178,28 @@ namespace NVSProjectMaker
         QStringList transformProdDir( TOptionTypeMap & currValues, const QString & origProdDir ) const;
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir )=0;
 
+        // calls func on every source and target path stored in the item, so they can be rewritten in place
+        virtual void forEachPath( const std::function< void( QString & path ) > & func );
+        void forEachOptionPath( const QString & optName, const std::function< void( QString & path ) > & func );
+
         QString dump() const;
         QStringList fOtherOptions;
         QString fPrevOption;
 
         int fLineNumber{ -1 };
+        int fLogIndex{ 0 }; // which of the build logs the item was read from
+        int fItemID{ -1 }; // unique across all the logs merged into one CBuildInfoData
+        qint64 fDurationMS{ -1 }; // run time of the task, only known for items from an MSBuild binary log
+        quint64 fFingerprint{ 0 }; // of the command line and the directory it ran in
+        int fRepeats{ 0 }; // identical commands that were skipped in favor of this one
+
+        // lazy items keep the raw command line until the options are needed
+        bool fLazy{ false };
+        QString fRawLine;
+        int fRawPos{ -1 };
+        QString fLazyTargetFile;
+        QString fOrigProdDir;
+        mutable std::once_flag fDecodeOnce;
         TOptionTypeMap fOptions;
         std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
         std::list< std::shared_ptr< SItem > > fDependencyItems;
@@ -172,37 +208,51 @@ namespace NVSProjectMaker
 
     struct SCompileItem : public SItem
     {
-        SCompileItem( int lineNum ) :
+        SCompileItem( int lineNum, bool lazyOptions ) :
             SItem( lineNum, Qt::CaseSensitivity::CaseSensitive )
         {
+            fLazy = lazyOptions;
         }
 
+        virtual bool loadDataLazy( const QString & line, int pos ) override;
+        // true when the token following prevOption names the object file
+        virtual bool targetFollowsOption( const QString & prevOption ) const = 0;
+        virtual const TOptionTypeMap & prototypeOptions() const = 0;
+        virtual void decodeRawLine() override;
+        virtual QStringList rawOptionValues() const override;
+
         virtual QString getItemTypeName() const { return "Compile"; }
         virtual Qt::CaseSensitivity caseInsensitiveOptions() const override { return Qt::CaseSensitive; }
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
 
         virtual QStringList allSources() const override;
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
 
         QStringList fSourceFiles;
+        std::vector< std::pair< int, QString > > fShowIncludes; // the /showIncludes notes after the command, nesting depth and header
     };
 
     struct SVSCLCompileItem : public SCompileItem
     {
-        SVSCLCompileItem( int lineNum );
+        SVSCLCompileItem( int lineNum, bool lazyOptions = false );
         virtual bool loadData( const QString & line, int pos ) override;
 
         virtual void initOptions();
         virtual QString targetFileOption() const override { return "Fo"; };
+        virtual bool targetFollowsOption( const QString & prevOption ) const override { return prevOption == ">"; }
+        virtual const TOptionTypeMap & prototypeOptions() const override;
 
     };
 
     struct SGccCompileItem : public SCompileItem
     {
-        SGccCompileItem( int lineNum );
+        SGccCompileItem( int lineNum, bool lazyOptions = false );
         virtual bool loadData( const QString & line, int pos ) override;
 
         virtual void initOptions();
         virtual QString targetFileOption() const override { return "o"; };
+        virtual bool targetFollowsOption( const QString & prevOption ) const override { return prevOption.compare( "o", Qt::CaseInsensitive ) == 0; }
+        virtual const TOptionTypeMap & prototypeOptions() const override;
     };
 
     struct SLibraryItem : public SItem
@@ -217,6 +267,7 @@ namespace NVSProjectMaker
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
         virtual QString getItemTypeName() const { return "Library"; }
         virtual bool srcPriorityForDir() const { return false; }
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
 
         QStringList fInputs;
     };
@@ -233,6 +284,7 @@ namespace NVSProjectMaker
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
         virtual QString getItemTypeName() const { return "App/DLL"; }
         virtual bool srcPriorityForDir() const { return false; }
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
 
         QStringList fFiles;
         QStringList fCommandFiles;
@@ -251,6 +303,7 @@ namespace NVSProjectMaker
         virtual Qt::CaseSensitivity caseInsensitiveOptions() const override { return Qt::CaseInsensitive; }
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
         virtual QString getItemTypeName() const { return "Manifest"; }
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
     };
 
     struct SObfuscatedItem : public SItem
@@ -265,10 +318,65 @@ namespace NVSProjectMaker
         virtual Qt::CaseSensitivity caseInsensitiveOptions() const override { return Qt::CaseInsensitive; }
         virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
         virtual QString getItemTypeName() const { return "Obfuscated"; }
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
 
         QString fInputFile;
     };
 
+    // moc, uic and rcc all run as "tool [options] inputs -o output", the output is a generated
+    // source that a later compile item picks up
+    struct SQtGeneratorItem : public SItem
+    {
+        SQtGeneratorItem( int lineNum );
+        virtual bool loadData( const QString & line, int pos ) override;
+
+        virtual QString targetFileOption() const override { return "o"; };
+
+        // only '-' starts an option, an absolute path on linux is an input or output
+        virtual bool isOptionToken( const QString & token ) const override { return token.startsWith( "-" ); }
+        virtual QString resolveOption( const TOptionTypeMap & options, const QString & option, QString & remainder ) const override;
+
+        virtual QStringList allSources() const override;
+        virtual Qt::CaseSensitivity caseInsensitiveOptions() const override { return Qt::CaseSensitive; }
+        virtual QStringList xformProdDirInSourceAndTarget( const QString & origProdDir );
+        virtual void forEachPath( const std::function< void( QString & path ) > & func ) override;
+
+        // the names are the option without its first '-', so the long options keep one
+        virtual const QStringList & valueOptions() const = 0; // options whose value may be the next argument
+        virtual const std::map< QString, QString > & optionAliases() const = 0; // the other spellings of an option
+        QString canonicalOption( const QString & optName ) const;
+        void addOptionValue( const QString & optName, const QString & value );
+
+        QStringList fInputFiles;
+    };
+
+    struct SMocItem : public SQtGeneratorItem
+    {
+        SMocItem( int lineNum ) : SQtGeneratorItem( lineNum ) { initOptions(); }
+        virtual void initOptions() override;
+        virtual const QStringList & valueOptions() const override;
+        virtual const std::map< QString, QString > & optionAliases() const override;
+        virtual QString getItemTypeName() const { return "Moc"; }
+    };
+
+    struct SUicItem : public SQtGeneratorItem
+    {
+        SUicItem( int lineNum ) : SQtGeneratorItem( lineNum ) { initOptions(); }
+        virtual void initOptions() override;
+        virtual const QStringList & valueOptions() const override;
+        virtual const std::map< QString, QString > & optionAliases() const override;
+        virtual QString getItemTypeName() const { return "Uic"; }
+    };
+
+    struct SRccItem : public SQtGeneratorItem
+    {
+        SRccItem( int lineNum ) : SQtGeneratorItem( lineNum ) { initOptions(); }
+        virtual void initOptions() override;
+        virtual const QStringList & valueOptions() const override;
+        virtual const std::map< QString, QString > & optionAliases() const override;
+        virtual QString getItemTypeName() const { return "Rcc"; }
+    };
+
     struct SDirItem
     {
         SDirItem( const QString & dirName );
@@ -281,25 +389,98 @@ namespace NVSProjectMaker
         std::list< std::shared_ptr< SExecItem > > fExecutables;
         std::list< std::shared_ptr< SManifestItem > > fManifests;
         std::list< std::shared_ptr< SObfuscatedItem > > fObfuscatedItems;
+        std::list< std::shared_ptr< SQtGeneratorItem > > fGeneratorItems;
+    };
+
+    // Where the time of a build output load goes.  Only filled in when requested, every
+    // measurement is behind a single flag check so a normal load pays nothing for it.
+    struct SBuildLoadStats
+    {
+        enum EStage
+        {
+            eRead,          // reading and decompressing lines, summed over the loader threads
+            eMatch,         // regular expression matching of the tool, summed over the loader threads
+            eDecode,        // option decoding, summed over the loader threads
+            eProdDir,       // ProdDir rewriting, summed over the loader threads
+            eLoad,          // wall time of the parallel load
+            eMerge,
+            eDependencies,
+            eTree,
+            eNumStages
+        };
+
+        static QString stageName( EStage stage );
+
+        SBuildLoadStats & operator+=( const SBuildLoadStats & rhs );
+        QList< QPair< QString, QString > > rows() const;
+        QString getText() const;
+
+        bool fEnabled{ false };
+        std::array< qint64, eNumStages > fStageNSecs{};
+        qint64 fBytesRead{ 0 };
+        qint64 fLinesRead{ 0 };
+        QList< QPair< QString, int > > fLinesPerTool;
+        qint64 fItems{ 0 };
+        qint64 fLazyItems{ 0 };
+        qint64 fUniquePaths{ 0 };
+        qint64 fOptionEntries{ 0 }; // option table entries allocated over all the items
+        int fPeakOptionCount{ 0 }; // most options set on a single item
+    };
+
+    // times one stage into an SBuildLoadStats, does nothing when the stats are disabled
+    class CStageTimer
+    {
+    public:
+        CStageTimer( SBuildLoadStats & stats, SBuildLoadStats::EStage stage ) :
+            fStats( stats.fEnabled ? &stats : nullptr ),
+            fStage( stage )
+        {
+            if ( fStats )
+                fStart = std::chrono::steady_clock::now();
+        }
+        ~CStageTimer()
+        {
+            stop();
+        }
+        qint64 stop()
+        {
+            if ( !fStats )
+                return 0;
+            auto retVal = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - fStart ).count();
+            fStats->fStageNSecs[ fStage ] += retVal;
+            fStats = nullptr;
+            return retVal;
+        }
+    private:
+        SBuildLoadStats * fStats{ nullptr };
+        SBuildLoadStats::EStage fStage;
+        std::chrono::steady_clock::time_point fStart;
     };
 
     class CBuildInfoData
     {
+        friend class CBuildInfoDatabase;
     public:
-        CBuildInfoData( const QString & fileName, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress );
+        // fileName may contain several ';' separated logs and/or wildcards, see expandFileNames
+        CBuildInfoData( const QString & fileName, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats = false );
+        CBuildInfoData( const QStringList & fileNames, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats = false );
+        // captures the commands with make --dry-run in each of the build directories rather than reading a log
+        CBuildInfoData( const SMakeDryRun & dryRun, std::function< void( const QString & msg ) > reportFunc, CSettings * settings, QProgressDialog * progress, bool collectStats = false );
         bool status() const { return fStatus.first; }
         QString errorString() const { return fStatus.second; }
 
         void loadIntoTree( QStandardItemModel * model );
-    private:
-        bool isSourceFile( const QString & fileName ) const;
-        void determineDependencies();
-        void cleanupProdDirUsages( QStringList & currData );
-        std::shared_ptr< SItem > loadLine( QRegularExpression & regExp, const QString & line, int lineNum, std::shared_ptr< SItem > item );
 
+        static QStringList expandFileNames( const QString & fileNames );
+        const QStringList & logFiles() const { return fLogFiles; }
+        const std::vector< std::shared_ptr< SItem > > & items() const { return fItems; } // ordered by item ID
+        const std::map< QString, std::shared_ptr< SDirItem > > & directories() const { return fDirectories; }
+        const SBuildLoadStats & stats() const { return fStats; }
+        QStringList generatedFiles() const; // the outputs of the moc, uic and rcc items
+    private:
         struct SStatusInfo
         {
-            int fLineNum;
+            int fLineNum{ 0 };
             int fNumCL{ 0 };
             int fNumGcc{ 0 };
             int fNumCygwinCC{ 0 };
@@ -311,20 +492,69 @@ namespace NVSProjectMaker
             int fNumUIC{ 0 };
             int fNumRcc{ 0 };
             int fNumUnloaded{ 0 };
+            int fNumRepeats{ 0 }; // command lines skipped because the same command was already loaded
+            int fNumShowIncludes{ 0 };
 
+            SStatusInfo & operator+=( const SStatusInfo & rhs );
+            QList< QPair< QString, int > > linesPerTool() const;
             QString getStatusString( size_t numDirectories, bool forGUI ) const;
         };
 
-        bool loadVSCl( const QString & line, int lineNum );
-        bool loadGcc( const QString & line, int lineNum );
-        bool loadLibrary( const QString & line, int lineNum );
-        bool loadLink( const QString & line, int lineNum );
-        bool loadManifest( const QString & line, int lineNum );
-        bool loadCygwinCC( const QString & line, int lineNum );
-        bool loadObfuscate( const QString & line, int lineNum );
-        bool loadMoc( const QString & line, int lineNum );
-        bool loadUic( const QString & line, int lineNum );
-        bool loadRcc(const QString & line, int lineNum);
+        // everything read from one build log, filled in on a worker thread and merged on the calling thread
+        struct SLogResult
+        {
+            SLogResult( const QString & fileName, int logIndex ) :
+                fFileName( fileName ),
+                fLogIndex( logIndex )
+            {
+            }
+            QString fFileName;
+            int fLogIndex{ 0 };
+            qint64 fSize{ 0 };
+            std::atomic< qint64 > fBytesRead{ 0 };
+            std::atomic< bool > fRunning{ false };
+            QStringList fDirStack; // from the make -w Entering/Leaving directory lines, relative paths are relative to the last one
+
+            std::list< std::shared_ptr< SItem > > fItems;
+            std::unordered_map< quint64, std::shared_ptr< SItem > > fFingerprints; // only lines that loaded an item
+            std::shared_ptr< SCompileItem > fLastCompileItem; // takes the /showIncludes notes that follow it
+            QStringList fMessages;
+            TStringSet fProdDirUsages;
+            SStatusInfo fStatusInfo;
+            SBuildLoadStats fStats;
+            std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
+        };
+        bool fLazyOptions{ false };
+        std::optional< SMakeDryRun > fDryRun;
+
+        void loadLogs( const QStringList & fileNames, QProgressDialog * progress, int maxConcurrent = 0 );
+        void loadLog( SLogResult * result, const std::atomic< bool > & canceled ) const;
+        template< typename T >
+        void loadTextLog( T & reader, SLogResult * result, const std::atomic< bool > & canceled ) const;
+        bool trackMakeDirectory( const QString & line, SLogResult & result ) const;
+        bool loadShowInclude( const QString & line, SLogResult & result ) const;
+        void loadBinLog( SLogResult * result, const std::atomic< bool > & canceled ) const;
+        void loadExecJournal( SLogResult * result, const std::atomic< bool > & canceled ) const;
+        std::shared_ptr< SItem > loadItem( const QString & line, SLogResult & result, bool reportUnhandled = true ) const;
+        int mergeLog( SLogResult * result ); // returns the number of commands already loaded from an earlier log
+        static quint64 commandFingerprint( const QString & line, const QString & dir );
+        QString internPath( const QString & path );
+        QString itemLocation( const std::shared_ptr< SItem > & item ) const;
+
+        void determineDependencies();
+        static void cleanupProdDirUsages( QStringList & currData );
+        std::shared_ptr< SItem > loadLine( QRegularExpression & regExp, const QString & line, int lineNum, std::shared_ptr< SItem > item, SLogResult & result ) const;
+
+        std::shared_ptr< SItem > loadVSCl( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadGcc( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadLibrary( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadLink( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadManifest( const QString & line, int lineNum, SLogResult & result ) const;
+        bool loadCygwinCC( const QString & line, int lineNum ) const;
+        std::shared_ptr< SItem > loadObfuscate( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadMoc( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadUic( const QString & line, int lineNum, SLogResult & result ) const;
+        std::shared_ptr< SItem > loadRcc( const QString & line, int lineNum, SLogResult & result ) const;
 
         void addItem( std::shared_ptr< SItem > item );
         std::shared_ptr< SDirItem > addDir( const QString & dir );
@@ -335,8 +565,14 @@ namespace NVSProjectMaker
         std::multimap< QString, std::shared_ptr< SItem > > fTargets;
         std::multimap< QString, std::shared_ptr< SItem > > fSources;
 
+        QStringList fLogFiles;
+        std::vector< std::shared_ptr< SItem > > fItems;
+        QSet< QString > fPathPool; // every path is stored once and shared between the items of all logs
+        std::unordered_map< quint64, std::shared_ptr< SItem > > fFingerprints;
+
         std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
         TStringSet fProdDirUsages;
+        SBuildLoadStats fStats;
     };
 }
 
@@ -0,0 +1,491 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "BuildInfoDatabase.h"
+#include "BuildInfoData.h"
+#include "Settings.h"
+
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+#include <map>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    static const int kSchemaVersion = 2; // 2 added the /showIncludes notes
+    static const int kBatchSize = 50000;
+
+    // a private connection that is removed again once the last QSqlDatabase copy is gone
+    class CConnection
+    {
+    public:
+        CConnection( const QString & fileName ) :
+            fName( QString( "NVSProjectMaker::CBuildInfoDatabase::%1" ).arg( reinterpret_cast< quintptr >( this ) ) )
+        {
+            fDB = QSqlDatabase::addDatabase( "QSQLITE", fName );
+            fDB.setDatabaseName( fileName );
+        }
+        ~CConnection()
+        {
+            fDB.close();
+            fDB = QSqlDatabase();
+            QSqlDatabase::removeDatabase( fName );
+        }
+        QSqlDatabase & db() { return fDB; }
+    private:
+        QString fName;
+        QSqlDatabase fDB;
+    };
+
+    // one prepared insert, the rows are bound column wise and sent in batches
+    class CBatchInsert
+    {
+    public:
+        CBatchInsert( QSqlDatabase & db, const QString & table, const QStringList & columns ) :
+            fQuery( db ),
+            fColumns( columns.count() )
+        {
+            QStringList placeHolders;
+            for ( int ii = 0; ii < columns.count(); ++ii )
+                placeHolders << "?";
+            fPrepared = fQuery.prepare( QString( "INSERT INTO %1 ( %2 ) VALUES ( %3 )" ).arg( table ).arg( columns.join( ", " ) ).arg( placeHolders.join( ", " ) ) );
+            if ( !fPrepared )
+                fError = fQuery.lastError().text();
+        }
+
+        void addRow( const QVariantList & values )
+        {
+            for ( int ii = 0; ii < values.count(); ++ii )
+                fColumns[ ii ] << values[ ii ];
+            if ( ++fNumRows >= kBatchSize )
+                flush();
+        }
+
+        bool flush()
+        {
+            if ( !fPrepared || !fError.isEmpty() )
+                return false;
+            if ( fNumRows == 0 )
+                return true;
+            for ( auto && ii : fColumns )
+                fQuery.addBindValue( ii );
+            if ( !fQuery.execBatch() )
+                fError = fQuery.lastError().text();
+            for ( auto && ii : fColumns )
+                ii.clear();
+            fNumRows = 0;
+            return fError.isEmpty();
+        }
+
+        QString errorString() const { return fError; }
+    private:
+        QSqlQuery fQuery;
+        std::vector< QVariantList > fColumns;
+        int fNumRows{ 0 };
+        bool fPrepared{ false };
+        QString fError;
+    };
+
+    static bool execAll( QSqlDatabase & db, const QStringList & statements, QString & error )
+    {
+        QSqlQuery query( db );
+        for ( auto && ii : statements )
+        {
+            if ( !query.exec( ii ) )
+            {
+                error = QString( "%1: %2" ).arg( ii ).arg( query.lastError().text() );
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool CBuildInfoDatabase::isDatabase( const QString & fileName )
+    {
+        auto suffix = QFileInfo( fileName ).suffix();
+        return ( suffix.compare( "sqlite", Qt::CaseInsensitive ) == 0 ) || ( suffix.compare( "db", Qt::CaseInsensitive ) == 0 );
+    }
+
+    QString CBuildInfoDatabase::itemKind( const std::shared_ptr< SItem > & item )
+    {
+        if ( std::dynamic_pointer_cast< SVSCLCompileItem >( item ) )
+            return "VSCL";
+        if ( std::dynamic_pointer_cast< SGccCompileItem >( item ) )
+            return "GCC";
+        if ( std::dynamic_pointer_cast< SLibraryItem >( item ) )
+            return "Library";
+        if ( std::dynamic_pointer_cast< SExecItem >( item ) )
+            return "Exec";
+        if ( std::dynamic_pointer_cast< SManifestItem >( item ) )
+            return "Manifest";
+        if ( std::dynamic_pointer_cast< SObfuscatedItem >( item ) )
+            return "Obfuscated";
+        if ( std::dynamic_pointer_cast< SMocItem >( item ) )
+            return "Moc";
+        if ( std::dynamic_pointer_cast< SUicItem >( item ) )
+            return "Uic";
+        if ( std::dynamic_pointer_cast< SRccItem >( item ) )
+            return "Rcc";
+        return QString();
+    }
+
+    std::shared_ptr< SItem > CBuildInfoDatabase::createItem( const QString & kind, int lineNum )
+    {
+        if ( kind == "VSCL" )
+            return std::make_shared< SVSCLCompileItem >( lineNum );
+        if ( kind == "GCC" )
+            return std::make_shared< SGccCompileItem >( lineNum );
+        if ( kind == "Library" )
+            return std::make_shared< SLibraryItem >( lineNum );
+        if ( kind == "Exec" )
+            return std::make_shared< SExecItem >( lineNum );
+        if ( kind == "Manifest" )
+            return std::make_shared< SManifestItem >( lineNum );
+        if ( kind == "Obfuscated" )
+            return std::make_shared< SObfuscatedItem >( lineNum );
+        if ( kind == "Moc" )
+            return std::make_shared< SMocItem >( lineNum );
+        if ( kind == "Uic" )
+            return std::make_shared< SUicItem >( lineNum );
+        if ( kind == "Rcc" )
+            return std::make_shared< SRccItem >( lineNum );
+        return nullptr;
+    }
+
+    std::pair< bool, QString > CBuildInfoDatabase::exportData( const CBuildInfoData & data, const QString & fileName )
+    {
+        // written under a temporary name and moved over fileName once complete, a failed export
+        // leaves no partial snapshot behind and an existing one untouched
+        auto tmpName = fileName + ".part";
+        if ( QFileInfo( tmpName ).exists() && !QFile::remove( tmpName ) )
+            return std::make_pair( false, QObject::tr( "Could not replace '%1'" ).arg( tmpName ) );
+
+        std::pair< bool, QString > retVal;
+        {
+            CConnection connection( tmpName );
+            if ( connection.db().open() )
+                retVal = writeTables( data, connection.db() );
+            else
+                retVal = std::make_pair( false, QObject::tr( "Could not create '%1': %2" ).arg( tmpName ).arg( connection.db().lastError().text() ) );
+        } // the connection is closed before the file is moved
+
+        if ( retVal.first && QFileInfo( fileName ).exists() && !QFile::remove( fileName ) )
+            retVal = std::make_pair( false, QObject::tr( "Could not replace '%1'" ).arg( fileName ) );
+        if ( retVal.first && !QFile::rename( tmpName, fileName ) )
+            retVal = std::make_pair( false, QObject::tr( "Could not rename '%1' to '%2'" ).arg( tmpName ).arg( fileName ) );
+        if ( !retVal.first )
+            QFile::remove( tmpName );
+        return retVal;
+    }
+
+    std::pair< bool, QString > CBuildInfoDatabase::writeTables( const CBuildInfoData & data, QSqlDatabase & db )
+    {
+        QString error;
+        // with no rollback journal a failed write cannot be undone, exportData removes the file instead
+        if ( !execAll( db, QStringList()
+             << "PRAGMA journal_mode = OFF"
+             << "PRAGMA synchronous = OFF"
+             << "CREATE TABLE meta ( key TEXT PRIMARY KEY, value TEXT )"
+             << "CREATE TABLE logs ( id INTEGER PRIMARY KEY, file_name TEXT )"
+             << "CREATE TABLE paths ( id INTEGER PRIMARY KEY, path TEXT )"
+             << "CREATE TABLE directories ( id INTEGER PRIMARY KEY, path_id INTEGER )"
+             << "CREATE TABLE items ( id INTEGER PRIMARY KEY, kind TEXT, log_id INTEGER, line_number INTEGER, dir_path_id INTEGER, target_path_id INTEGER, duration_ms INTEGER, repeats INTEGER, fingerprint INTEGER )"
+             << "CREATE TABLE item_options ( item_id INTEGER, name TEXT, type INTEGER, has_colon INTEGER, bool_value INTEGER, string_value TEXT, list_index INTEGER )"
+             << "CREATE TABLE item_files ( item_id INTEGER, role TEXT, seq INTEGER, path_id INTEGER )"
+             << "CREATE TABLE item_other_options ( item_id INTEGER, seq INTEGER, value TEXT )"
+             << "CREATE TABLE show_includes ( item_id INTEGER, seq INTEGER, depth INTEGER, path_id INTEGER )"
+             << "CREATE TABLE dependencies ( item_id INTEGER, dependency_id INTEGER, kind TEXT )"
+             << "CREATE TABLE prod_dir_usages ( path TEXT )"
+             , error ) )
+            return std::make_pair( false, error );
+
+        if ( !db.transaction() )
+            return std::make_pair( false, db.lastError().text() );
+
+        CBatchInsert metaInsert( db, "meta", { "key", "value" } );
+        CBatchInsert logInsert( db, "logs", { "id", "file_name" } );
+        CBatchInsert pathInsert( db, "paths", { "id", "path" } );
+        CBatchInsert dirInsert( db, "directories", { "id", "path_id" } );
+        CBatchInsert itemInsert( db, "items", { "id", "kind", "log_id", "line_number", "dir_path_id", "target_path_id", "duration_ms", "repeats", "fingerprint" } );
+        CBatchInsert optionInsert( db, "item_options", { "item_id", "name", "type", "has_colon", "bool_value", "string_value", "list_index" } );
+        CBatchInsert fileInsert( db, "item_files", { "item_id", "role", "seq", "path_id" } );
+        CBatchInsert otherInsert( db, "item_other_options", { "item_id", "seq", "value" } );
+        CBatchInsert showIncludeInsert( db, "show_includes", { "item_id", "seq", "depth", "path_id" } );
+        CBatchInsert depInsert( db, "dependencies", { "item_id", "dependency_id", "kind" } );
+        CBatchInsert prodDirInsert( db, "prod_dir_usages", { "path" } );
+
+        metaInsert.addRow( { "schema_version", kSchemaVersion } );
+        metaInsert.addRow( { "bld_txt_prod_dir", data.fSettings ? data.fSettings->getBldTxtProdDir() : QString() } );
+
+        for ( int ii = 0; ii < data.fLogFiles.count(); ++ii )
+            logInsert.addRow( { ii, data.fLogFiles[ ii ] } );
+
+        QHash< QString, qint64 > pathIDs;
+        auto pathID = [&pathIDs, &pathInsert]( const QString & path ) -> QVariant
+        {
+            if ( path.isEmpty() )
+                return QVariant( QVariant::LongLong );
+            auto pos = pathIDs.find( path );
+            if ( pos != pathIDs.end() )
+                return pos.value();
+            auto id = static_cast< qint64 >( pathIDs.size() );
+            pathIDs.insert( path, id );
+            pathInsert.addRow( { id, path } );
+            return id;
+        };
+
+        int dirID = 0;
+        for ( auto && ii : data.fDirectories )
+            dirInsert.addRow( { dirID++, pathID( ii.first ) } );
+
+        for ( auto && item : data.fItems )
+        {
+            auto id = item->fItemID;
+            itemInsert.addRow( { id, itemKind( item ), item->fLogIndex, item->fLineNumber, pathID( item->dirForItem() ), pathID( item->targetFile() ),
+                                 ( item->fDurationMS >= 0 ) ? QVariant( item->fDurationMS ) : QVariant( QVariant::LongLong ), item->fRepeats, static_cast< qint64 >( item->fFingerprint ) } );
+
+            for ( auto && opt : item->options() )
+            {
+                auto && value = std::get< 2 >( opt.second );
+                if ( !value.has_value() )
+                    continue;
+                auto type = std::get< 0 >( opt.second );
+                auto hasColon = std::get< 1 >( opt.second );
+                auto && [ boolValue, stringValue, listValue ] = value.value();
+                if ( type == EOptionType::eStringList )
+                {
+                    for ( int ii = 0; ii < listValue.count(); ++ii )
+                        optionInsert.addRow( { id, opt.first, static_cast< int >( type ), hasColon, boolValue, listValue[ ii ], ii } );
+                }
+                else
+                    optionInsert.addRow( { id, opt.first, static_cast< int >( type ), hasColon, boolValue, stringValue, QVariant( QVariant::Int ) } );
+            }
+
+            auto addFiles = [&fileInsert, &pathID, id]( const QString & role, const QStringList & files )
+            {
+                for ( int ii = 0; ii < files.count(); ++ii )
+                    fileInsert.addRow( { id, role, ii, pathID( files[ ii ] ) } );
+            };
+            if ( auto compileItem = std::dynamic_pointer_cast< SCompileItem >( item ) )
+            {
+                addFiles( "source", compileItem->fSourceFiles );
+                for ( int ii = 0; ii < static_cast< int >( compileItem->fShowIncludes.size() ); ++ii )
+                    showIncludeInsert.addRow( { id, ii, compileItem->fShowIncludes[ ii ].first, pathID( compileItem->fShowIncludes[ ii ].second ) } );
+            }
+            else if ( auto libItem = std::dynamic_pointer_cast< SLibraryItem >( item ) )
+                addFiles( "input", libItem->fInputs );
+            else if ( auto execItem = std::dynamic_pointer_cast< SExecItem >( item ) )
+            {
+                addFiles( "file", execItem->fFiles );
+                addFiles( "command_file", execItem->fCommandFiles );
+            }
+            else if ( auto obfItem = std::dynamic_pointer_cast< SObfuscatedItem >( item ) )
+                addFiles( "input", QStringList() << obfItem->fInputFile );
+            else if ( auto genItem = std::dynamic_pointer_cast< SQtGeneratorItem >( item ) )
+                addFiles( "input", genItem->fInputFiles );
+
+            for ( int ii = 0; ii < item->fOtherOptions.count(); ++ii )
+                otherInsert.addRow( { id, ii, item->fOtherOptions[ ii ] } );
+
+            for ( auto && dep : item->fDependencyItems )
+                depInsert.addRow( { id, dep->fItemID, "source" } );
+            if ( item->fTargetItem )
+                depInsert.addRow( { id, item->fTargetItem->fItemID, "target" } );
+        }
+
+        for ( auto && ii : data.fProdDirUsages )
+            prodDirInsert.addRow( { ii } );
+
+        for ( auto && ii : { &metaInsert, &logInsert, &pathInsert, &dirInsert, &itemInsert, &optionInsert, &fileInsert, &otherInsert, &showIncludeInsert, &depInsert, &prodDirInsert } )
+        {
+            if ( !ii->flush() )
+            {
+                db.rollback();
+                return std::make_pair( false, ii->errorString() );
+            }
+        }
+
+        // the indexes are built once over the loaded rows rather than maintained row by row
+        if ( !execAll( db, QStringList()
+             << "CREATE UNIQUE INDEX paths_path ON paths ( path )"
+             << "CREATE INDEX items_target ON items ( target_path_id )"
+             << "CREATE INDEX items_dir ON items ( dir_path_id )"
+             << "CREATE INDEX item_options_item ON item_options ( item_id )"
+             << "CREATE INDEX item_options_name ON item_options ( name )"
+             << "CREATE INDEX item_files_item ON item_files ( item_id )"
+             << "CREATE INDEX item_files_path ON item_files ( path_id )"
+             << "CREATE INDEX item_other_options_item ON item_other_options ( item_id )"
+             << "CREATE INDEX show_includes_item ON show_includes ( item_id )"
+             << "CREATE INDEX dependencies_item ON dependencies ( item_id )"
+             << "CREATE INDEX dependencies_dependency ON dependencies ( dependency_id )"
+             << "CREATE VIEW sources AS SELECT item_files.item_id, item_files.role, paths.path FROM item_files JOIN paths ON paths.id = item_files.path_id"
+             << "CREATE VIEW targets AS SELECT items.id AS item_id, items.kind, paths.path FROM items JOIN paths ON paths.id = items.target_path_id"
+             , error ) )
+        {
+            db.rollback();
+            return std::make_pair( false, error );
+        }
+
+        if ( !db.commit() )
+            return std::make_pair( false, db.lastError().text() );
+        return std::make_pair( true, QString() );
+    }
+
+    std::pair< bool, QString > CBuildInfoDatabase::importData( CBuildInfoData & data, const QString & fileName )
+    {
+        CConnection connection( fileName );
+        auto && db = connection.db();
+        if ( !db.open() )
+            return std::make_pair( false, QObject::tr( "Could not open '%1': %2" ).arg( fileName ).arg( db.lastError().text() ) );
+
+        QSqlQuery query( db );
+        query.setForwardOnly( true );
+        if ( !query.exec( "SELECT value FROM meta WHERE key = 'schema_version'" ) || !query.next() || ( query.value( 0 ).toInt() != kSchemaVersion ) )
+            return std::make_pair( false, QObject::tr( "'%1' is not a build data snapshot of this version" ).arg( fileName ) );
+
+        std::vector< QString > paths;
+        if ( !query.exec( "SELECT id, path FROM paths ORDER BY id" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto id = query.value( 0 ).toLongLong();
+            if ( id >= static_cast< qint64 >( paths.size() ) )
+                paths.resize( id + 1 );
+            paths[ id ] = data.internPath( query.value( 1 ).toString() );
+        }
+        auto path = [&paths]( const QVariant & id )
+        {
+            auto index = id.isNull() ? -1 : id.toLongLong();
+            return ( ( index >= 0 ) && ( index < static_cast< qint64 >( paths.size() ) ) ) ? paths[ index ] : QString();
+        };
+
+        data.fLogFiles.clear();
+        if ( !query.exec( "SELECT file_name FROM logs ORDER BY id" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+            data.fLogFiles << query.value( 0 ).toString();
+
+        std::map< int, std::shared_ptr< SItem > > items;
+        if ( !query.exec( "SELECT id, kind, log_id, line_number, duration_ms, repeats, fingerprint FROM items ORDER BY id" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto item = createItem( query.value( 1 ).toString(), query.value( 3 ).toInt() );
+            if ( !item )
+                continue;
+            item->fItemID = query.value( 0 ).toInt();
+            item->fLogIndex = query.value( 2 ).toInt();
+            item->fDurationMS = query.value( 4 ).isNull() ? -1 : query.value( 4 ).toLongLong();
+            item->fRepeats = query.value( 5 ).toInt();
+            item->fFingerprint = static_cast< quint64 >( query.value( 6 ).toLongLong() );
+            item->fStatus = std::make_pair( true, QString() );
+            items[ item->fItemID ] = item;
+        }
+
+        if ( !query.exec( "SELECT item_id, name, type, has_colon, bool_value, string_value, list_index FROM item_options ORDER BY item_id, name, list_index" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto pos = items.find( query.value( 0 ).toInt() );
+            if ( pos == items.end() )
+                continue;
+            auto && option = ( *pos ).second->fOptions[ query.value( 1 ).toString() ];
+            std::get< 0 >( option ) = static_cast< EOptionType >( query.value( 2 ).toInt() );
+            std::get< 1 >( option ) = query.value( 3 ).toBool();
+            auto && value = std::get< 2 >( option );
+            if ( !value.has_value() )
+                value = std::make_tuple( query.value( 4 ).toBool(), QString(), QStringList() );
+            if ( std::get< 0 >( option ) == EOptionType::eStringList )
+                std::get< 2 >( value.value() ) << query.value( 5 ).toString();
+            else
+                std::get< 1 >( value.value() ) = query.value( 5 ).toString();
+        }
+
+        if ( !query.exec( "SELECT item_id, role, path_id FROM item_files ORDER BY item_id, role, seq" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto pos = items.find( query.value( 0 ).toInt() );
+            if ( pos == items.end() )
+                continue;
+            auto && item = ( *pos ).second;
+            auto role = query.value( 1 ).toString();
+            auto file = path( query.value( 2 ) );
+            if ( auto compileItem = std::dynamic_pointer_cast< SCompileItem >( item ) )
+                compileItem->fSourceFiles << file;
+            else if ( auto libItem = std::dynamic_pointer_cast< SLibraryItem >( item ) )
+                libItem->fInputs << file;
+            else if ( auto execItem = std::dynamic_pointer_cast< SExecItem >( item ) )
+                ( ( role == "command_file" ) ? execItem->fCommandFiles : execItem->fFiles ) << file;
+            else if ( auto obfItem = std::dynamic_pointer_cast< SObfuscatedItem >( item ) )
+                obfItem->fInputFile = file;
+            else if ( auto genItem = std::dynamic_pointer_cast< SQtGeneratorItem >( item ) )
+                genItem->fInputFiles << file;
+        }
+
+        if ( !query.exec( "SELECT item_id, value FROM item_other_options ORDER BY item_id, seq" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto pos = items.find( query.value( 0 ).toInt() );
+            if ( pos != items.end() )
+                ( *pos ).second->fOtherOptions << query.value( 1 ).toString();
+        }
+
+        if ( !query.exec( "SELECT item_id, depth, path_id FROM show_includes ORDER BY item_id, seq" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+        {
+            auto pos = items.find( query.value( 0 ).toInt() );
+            if ( pos == items.end() )
+                continue;
+            if ( auto compileItem = std::dynamic_pointer_cast< SCompileItem >( ( *pos ).second ) )
+                compileItem->fShowIncludes.push_back( std::make_pair( query.value( 1 ).toInt(), path( query.value( 2 ) ) ) );
+        }
+
+        if ( !query.exec( "SELECT path FROM prod_dir_usages" ) )
+            return std::make_pair( false, query.lastError().text() );
+        while ( query.next() )
+            data.fProdDirUsages.insert( query.value( 0 ).toString() );
+
+        // the dependency edges are derived data, they are rebuilt rather than read so they match this version's rules
+        for ( auto && ii : items )
+        {
+            auto && item = ii.second;
+            item->fItemID = static_cast< int >( data.fItems.size() );
+            item->forEachPath( [&data]( QString & path ) { path = data.internPath( path ); } );
+            data.fFingerprints[ item->fFingerprint ] = item;
+            data.fItems.push_back( item );
+            data.addItem( item );
+        }
+        data.determineDependencies();
+        return std::make_pair( true, QString() );
+    }
+}
@@ -0,0 +1,58 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __BUILDINFODATABASE_H
+#define __BUILDINFODATABASE_H
+
+#include <QString>
+#include <utility>
+#include <memory>
+
+class QSqlDatabase;
+
+namespace NVSProjectMaker
+{
+    class CBuildInfoData;
+    struct SItem;
+
+    // Writes the parsed build data to a SQLite file for ad hoc SQL, and reads such a snapshot back
+    // into a CBuildInfoData so the build output does not need to be parsed again.
+    //
+    // Tables: meta, logs, paths, directories, items, item_options, item_files, item_other_options,
+    // show_includes, dependencies and prod_dir_usages, with the sources and targets views over them.
+    // All paths are stored once in paths and referenced by id.
+    class CBuildInfoDatabase
+    {
+    public:
+        static bool isDatabase( const QString & fileName );
+
+        static std::pair< bool, QString > exportData( const CBuildInfoData & data, const QString & fileName );
+        static std::pair< bool, QString > importData( CBuildInfoData & data, const QString & fileName );
+    private:
+        static std::pair< bool, QString > writeTables( const CBuildInfoData & data, QSqlDatabase & db );
+        static std::shared_ptr< SItem > createItem( const QString & kind, int lineNum );
+        static QString itemKind( const std::shared_ptr< SItem > & item );
+    };
+}
+
+#endif
@@ -0,0 +1,380 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "BuildOutputReader.h"
+
+#include <QObject>
+#include <QFile>
+#include <QFileInfo>
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace NVSProjectMaker
+{
+    static const qint64 kReadBlockSize = 1024 * 1024;
+    static const size_t kMaxQueuedBlocks = 8;
+
+    CBuildOutputReader::CBuildOutputReader( const QString & fileName ) :
+        fFileName( fileName )
+    {
+    }
+
+    CBuildOutputReader::~CBuildOutputReader()
+    {
+        close();
+    }
+
+    CBuildOutputReader::ECompression CBuildOutputReader::detectCompression( const QByteArray & header )
+    {
+        if ( ( header.length() >= 2 ) && ( static_cast< uchar >( header[ 0 ] ) == 0x1f ) && ( static_cast< uchar >( header[ 1 ] ) == 0x8b ) )
+            return ECompression::eGZip;
+        if ( ( header.length() >= 4 ) && ( static_cast< uchar >( header[ 0 ] ) == 0x28 ) && ( static_cast< uchar >( header[ 1 ] ) == 0xb5 ) && ( static_cast< uchar >( header[ 2 ] ) == 0x2f ) && ( static_cast< uchar >( header[ 3 ] ) == 0xfd ) )
+            return ECompression::eZStd;
+        return ECompression::eNone;
+    }
+
+    QString CBuildOutputReader::compressionName( ECompression compression )
+    {
+        switch ( compression )
+        {
+            case ECompression::eGZip:
+                return "gzip";
+            case ECompression::eZStd:
+                return "zstd";
+            case ECompression::eNone:
+            default:
+                return "none";
+        }
+    }
+
+    bool CBuildOutputReader::open()
+    {
+        close();
+
+        fFile = std::make_unique< QFile >( fFileName );
+        if ( !fFile->open( QFile::ReadOnly ) )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "'%1' could not be opened for reading" ).arg( fFileName ) );
+            return false;
+        }
+        fSize = fFile->size();
+        fCompressedPos = 0;
+        fCompression = detectCompression( fFile->peek( 4 ) );
+
+#ifndef HAVE_ZLIB
+        if ( fCompression == ECompression::eGZip )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "'%1' is gzip compressed, but zlib support was not built in" ).arg( fFileName ) );
+            return false;
+        }
+#endif
+#ifndef HAVE_ZSTD
+        if ( fCompression == ECompression::eZStd )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "'%1' is zstd compressed, but zstd support was not built in" ).arg( fFileName ) );
+            return false;
+        }
+#endif
+
+        fStatus = std::make_pair( true, QString() );
+        fProducerDone = false;
+        fStopProducer = false;
+        fProducer = std::thread( [this]() { runProducer(); } );
+        return true;
+    }
+
+    void CBuildOutputReader::close()
+    {
+        if ( fProducer.joinable() )
+        {
+            {
+                std::unique_lock< std::mutex > lock( fMutex );
+                fStopProducer = true;
+            }
+            fSpaceAvailable.notify_all();
+            fProducer.join();
+        }
+        fBlocks.clear();
+        fCurrent.clear();
+        fCurrentPos = 0;
+        fFile.reset();
+    }
+
+    void CBuildOutputReader::setError( const QString & msg )
+    {
+        std::unique_lock< std::mutex > lock( fMutex );
+        fStatus = std::make_pair( false, msg );
+    }
+
+    void CBuildOutputReader::runProducer()
+    {
+        switch ( fCompression )
+        {
+            case ECompression::eGZip:
+                readGZip();
+                break;
+            case ECompression::eZStd:
+                readZStd();
+                break;
+            case ECompression::eNone:
+                readPlain();
+                break;
+        }
+
+        {
+            std::unique_lock< std::mutex > lock( fMutex );
+            fProducerDone = true;
+        }
+        fBlockAvailable.notify_all();
+    }
+
+    // returns false when the consumer has asked the producer to stop
+    bool CBuildOutputReader::pushBlock( QByteArray && block )
+    {
+        std::unique_lock< std::mutex > lock( fMutex );
+        fSpaceAvailable.wait( lock, [this]() { return fStopProducer || ( fBlocks.size() < kMaxQueuedBlocks ); } );
+        if ( fStopProducer )
+            return false;
+        fBlocks.push_back( std::move( block ) );
+        lock.unlock();
+        fBlockAvailable.notify_one();
+        return true;
+    }
+
+    bool CBuildOutputReader::readPlain()
+    {
+        while ( !fFile->atEnd() )
+        {
+            auto block = fFile->read( kReadBlockSize );
+            if ( block.isEmpty() )
+                break;
+            fCompressedPos = fFile->pos();
+            if ( !pushBlock( std::move( block ) ) )
+                return false;
+        }
+        return true;
+    }
+
+    bool CBuildOutputReader::readGZip()
+    {
+#ifdef HAVE_ZLIB
+        z_stream stream = {};
+        if ( inflateInit2( &stream, 15 + 32 ) != Z_OK ) // 32 - detect the gzip header
+        {
+            setError( QObject::tr( "'%1' could not initialize gzip decompression" ).arg( fFileName ) );
+            return false;
+        }
+
+        bool aOK = true;
+        bool streamEnded = false;
+        bool outputFull = false;
+        QByteArray input;
+        while ( aOK )
+        {
+            if ( ( stream.avail_in == 0 ) && !outputFull )
+            {
+                input = fFile->read( kReadBlockSize );
+                if ( input.isEmpty() )
+                {
+                    // without the end of the last member the rest of the build is missing
+                    if ( !streamEnded )
+                    {
+                        setError( QObject::tr( "'%1' is truncated, the gzip stream does not end" ).arg( fFileName ) );
+                        aOK = false;
+                    }
+                    break;
+                }
+                fCompressedPos = fFile->pos();
+                stream.next_in = reinterpret_cast< Bytef * >( input.data() );
+                stream.avail_in = static_cast< uInt >( input.size() );
+            }
+
+            if ( streamEnded && ( stream.avail_in != 0 ) )
+            {
+                // concatenated gzip members, as produced by appending to a .gz log
+                inflateReset( &stream );
+                streamEnded = false;
+            }
+
+            QByteArray output( kReadBlockSize, Qt::Uninitialized );
+            stream.next_out = reinterpret_cast< Bytef * >( output.data() );
+            stream.avail_out = static_cast< uInt >( output.size() );
+            auto result = inflate( &stream, Z_NO_FLUSH );
+            if ( ( result != Z_OK ) && ( result != Z_STREAM_END ) && ( result != Z_BUF_ERROR ) )
+            {
+                setError( QObject::tr( "'%1' is not a valid gzip file: %2" ).arg( fFileName ).arg( stream.msg ? stream.msg : "unknown error" ) );
+                aOK = false;
+                break;
+            }
+            streamEnded = ( result == Z_STREAM_END );
+            outputFull = ( stream.avail_out == 0 );
+
+            output.resize( output.size() - static_cast< int >( stream.avail_out ) );
+            if ( !output.isEmpty() && !pushBlock( std::move( output ) ) )
+                aOK = false;
+        }
+        inflateEnd( &stream );
+        return aOK;
+#else
+        return false;
+#endif
+    }
+
+    bool CBuildOutputReader::readZStd()
+    {
+#ifdef HAVE_ZSTD
+        auto stream = ZSTD_createDStream();
+        if ( !stream )
+        {
+            setError( QObject::tr( "'%1' could not initialize zstd decompression" ).arg( fFileName ) );
+            return false;
+        }
+        auto initResult = ZSTD_initDStream( stream );
+        if ( ZSTD_isError( initResult ) )
+        {
+            setError( QObject::tr( "'%1' could not initialize zstd decompression: %2" ).arg( fFileName ).arg( ZSTD_getErrorName( initResult ) ) );
+            ZSTD_freeDStream( stream );
+            return false;
+        }
+
+        bool aOK = true;
+        bool frameEnded = false; // ZSTD_decompressStream returns 0 once a frame is decoded and flushed
+        bool outputFull = false;
+        QByteArray input;
+        ZSTD_inBuffer inBuffer = { nullptr, 0, 0 };
+        while ( aOK )
+        {
+            if ( ( inBuffer.pos == inBuffer.size ) && !outputFull )
+            {
+                input = fFile->read( kReadBlockSize );
+                if ( input.isEmpty() )
+                {
+                    if ( !frameEnded )
+                    {
+                        setError( QObject::tr( "'%1' is truncated, the zstd frame does not end" ).arg( fFileName ) );
+                        aOK = false;
+                    }
+                    break;
+                }
+                fCompressedPos = fFile->pos();
+                inBuffer = { input.data(), static_cast< size_t >( input.size() ), 0 };
+            }
+
+            QByteArray output( kReadBlockSize, Qt::Uninitialized );
+            ZSTD_outBuffer outBuffer = { output.data(), static_cast< size_t >( output.size() ), 0 };
+            auto result = ZSTD_decompressStream( stream, &outBuffer, &inBuffer );
+            if ( ZSTD_isError( result ) )
+            {
+                setError( QObject::tr( "'%1' is not a valid zstd file: %2" ).arg( fFileName ).arg( ZSTD_getErrorName( result ) ) );
+                aOK = false;
+                break;
+            }
+
+            frameEnded = ( result == 0 );
+            outputFull = ( outBuffer.pos == outBuffer.size );
+            output.resize( static_cast< int >( outBuffer.pos ) );
+            if ( !output.isEmpty() && !pushBlock( std::move( output ) ) )
+                aOK = false;
+        }
+        ZSTD_freeDStream( stream );
+        return aOK;
+#else
+        return false;
+#endif
+    }
+
+    // makes sure fCurrent has unread data, returns false at the end of the data
+    bool CBuildOutputReader::fillCurrent()
+    {
+        if ( fCurrentPos < fCurrent.size() )
+            return true;
+
+        std::unique_lock< std::mutex > lock( fMutex );
+        fBlockAvailable.wait( lock, [this]() { return fProducerDone || !fBlocks.empty(); } );
+        if ( fBlocks.empty() )
+            return false;
+
+        fCurrent = std::move( fBlocks.front() );
+        fBlocks.pop_front();
+        fCurrentPos = 0;
+        lock.unlock();
+        fSpaceAvailable.notify_one();
+        return true;
+    }
+
+    bool CBuildOutputReader::atEnd()
+    {
+        return !fillCurrent();
+    }
+
+    bool CBuildOutputReader::readLine( QString & line )
+    {
+        line.clear();
+        if ( !fillCurrent() )
+            return false;
+
+        QByteArray pending;
+        while ( true )
+        {
+            auto eol = fCurrent.indexOf( '\n', fCurrentPos );
+            if ( eol != -1 )
+            {
+                pending.append( fCurrent.constData() + fCurrentPos, eol - fCurrentPos );
+                fCurrentPos = eol + 1;
+                break;
+            }
+
+            pending.append( fCurrent.constData() + fCurrentPos, fCurrent.size() - fCurrentPos );
+            fCurrentPos = fCurrent.size();
+            if ( !fillCurrent() )
+                break;
+        }
+
+        if ( pending.endsWith( '\r' ) )
+            pending.chop( 1 );
+        line = QString::fromLocal8Bit( pending );
+        return true;
+    }
+
+    qint64 CBuildOutputReader::read( char * data, qint64 maxSize )
+    {
+        qint64 retVal = 0;
+        while ( ( retVal < maxSize ) && fillCurrent() )
+        {
+            auto numBytes = std::min( maxSize - retVal, static_cast< qint64 >( fCurrent.size() - fCurrentPos ) );
+            memcpy( data + retVal, fCurrent.constData() + fCurrentPos, numBytes );
+            fCurrentPos += static_cast< int >( numBytes );
+            retVal += numBytes;
+        }
+        return retVal;
+    }
+}
@@ -0,0 +1,103 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __BUILDOUTPUTREADER_H
+#define __BUILDOUTPUTREADER_H
+
+#include <QString>
+#include <QByteArray>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class QFile;
+
+namespace NVSProjectMaker
+{
+    // Reads a build output file line by line.  gzip and zstd compressed files are detected by
+    // their magic bytes and decompressed on a separate thread, so decompression overlaps with
+    // the parsing done by the caller.  Plain files go through the same pipeline as read-ahead.
+    class CBuildOutputReader
+    {
+    public:
+        enum class ECompression
+        {
+            eNone,
+            eGZip,
+            eZStd
+        };
+
+        CBuildOutputReader( const QString & fileName );
+        ~CBuildOutputReader();
+
+        bool open();
+        void close();
+
+        bool status() const { return fStatus.first; }
+        QString errorString() const { return fStatus.second; }
+
+        ECompression compression() const { return fCompression; }
+        qint64 size() const { return fSize; } // size on disk
+        qint64 pos() const { return fCompressedPos; } // bytes on disk consumed so far, safe to call from any thread
+
+        bool readLine( QString & line );
+        qint64 read( char * data, qint64 maxSize ); // raw decompressed bytes
+        bool atEnd();
+
+        static ECompression detectCompression( const QByteArray & header );
+        static QString compressionName( ECompression compression );
+    private:
+        void runProducer();
+        bool readPlain();
+        bool readGZip();
+        bool readZStd();
+
+        bool pushBlock( QByteArray && block );
+        bool fillCurrent();
+        void setError( const QString & msg );
+
+        QString fFileName;
+        std::unique_ptr< QFile > fFile;
+        ECompression fCompression{ ECompression::eNone };
+        qint64 fSize{ 0 };
+        std::atomic< qint64 > fCompressedPos{ 0 };
+
+        std::thread fProducer;
+        std::mutex fMutex;
+        std::condition_variable fBlockAvailable;
+        std::condition_variable fSpaceAvailable;
+        std::deque< QByteArray > fBlocks;
+        bool fProducerDone{ false };
+        bool fStopProducer{ false };
+
+        QByteArray fCurrent;
+        int fCurrentPos{ 0 };
+
+        std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
+    };
+}
+
+#endif
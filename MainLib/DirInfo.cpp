@@ -24,6 +24,9 @@
 #include "DebugTarget.h"
 #include "VSProjectMaker.h"
 #include "Settings.h"
+#include "FlatSourceTree.h"
+#include "FileClassifier.h"
+#include "PchRecommender.h"
 #include "SABUtils/QtUtils.h"
 
 #include <QStandardItem>
@@ -31,22 +34,21 @@
 #include <QApplication>
 #include <QMessageBox>
 #include <QTextStream>
-#include <unordered_set>
 
 namespace NVSProjectMaker
 {
-    SDirInfo::SDirInfo( const std::shared_ptr< SSourceFileInfo > & fileInfo ) :
-        fIsInclDir( fileInfo->fIsIncludeDir ),
-        fIsBuildDir( fileInfo->fIsBuildDir ),
-        fExecutables( fileInfo->fExecutables )
+    SDirInfo::SDirInfo( const CFlatSourceTree & tree, int index ) :
+        fIsInclDir( tree.hasFlag( index, SFlatSourceNode::eIsIncludeDir ) ),
+        fIsBuildDir( tree.hasFlag( index, SFlatSourceNode::eIsBuildDir ) ),
+        fExecutables( tree.executables( index ) )
     {
-        computeRelToDir( fileInfo );
-        getFiles( fileInfo );
+        computeRelToDir( tree.relPath( index ) );
+        getFiles( tree, index );
     }
 
-    void SDirInfo::computeRelToDir( const std::shared_ptr< SSourceFileInfo > & fileInfo )
+    void SDirInfo::computeRelToDir( const QString & relToDir )
     {
-        fRelToDir = fileInfo->fRelToDir;
+        fRelToDir = relToDir;
         fProjectName = fRelToDir;
         fProjectName.replace( "/", "_" );
         fProjectName = fProjectName.replace( "\\", "_" );
@@ -72,6 +74,28 @@ namespace NVSProjectMaker
         text.replace( variable, value );
     }
 
+    // the headers are listed for target_precompile_headers, the target itself is built by the external makefile
+    QString SDirInfo::getPchHeaders() const
+    {
+        if ( !fPchRecommendation || fPchRecommendation->isEmpty() )
+            return QString();
+
+        QStringList retVal;
+        retVal << QString( "# Precompiled header candidates, estimated to save %1 of %2 header parses over %3 translation units" )
+            .arg( fPchRecommendation->fEstimatedSaving ).arg( fPchRecommendation->fTotalParses ).arg( fPchRecommendation->fNumTUs );
+        retVal << "set(project_PCH_HEADERS";
+        for ( auto && ii : fPchRecommendation->headers() )
+        {
+            if ( QDir::isAbsolutePath( ii ) )
+                retVal << QString( "    \"%1\"" ).arg( ii );
+            else
+                retVal << QString( "    \"${ROOT_SOURCE_DIR}/%1\"" ).arg( ii );
+        }
+        retVal << ")";
+        retVal << QString( "# target_precompile_headers( %1 PRIVATE ${project_PCH_HEADERS} )" ).arg( fProjectName );
+        return retVal.join( "\n" );
+    }
+
     QStringList SDirInfo::getSubDirs() const
     {
         QStringList retVal;
@@ -304,6 +328,7 @@ namespace NVSProjectMaker
             replaceFiles( resourceText, "<BUILD_FILES>", QStringList() << fBuildFiles );
             replaceFiles( resourceText, "<OTHER_FILES>", QStringList() << fOtherFiles );
             replaceFiles( resourceText, "<YAML_FILES>", QStringList() << fYAMLFiles );
+            resourceText.replace( "<PCH_HEADERS>", getPchHeaders() );
             resourceText.replace( "<PROPSFILENAME>", "PropertySheetIncludes.props" );
         }
         );
@@ -344,67 +369,76 @@ namespace NVSProjectMaker
             ;
     }
 
-    void SDirInfo::getFiles( const std::shared_ptr< SSourceFileInfo > & fileInfo )
+    void SDirInfo::getFiles( const CFlatSourceTree & tree, int index )
     {
-        if ( !fileInfo || !fileInfo->fIsDir )
+        if ( !tree.isDir( index ) )
             return;
 
-        for ( auto && curr : fileInfo->fChildren )
+        // the directory's path is built once, each file adds its name to it
+        auto dirPath = tree.relPath( index );
+        if ( !dirPath.isEmpty() )
+            dirPath += '/';
+        for ( auto curr = tree.node( index ).fFirstChild; curr != -1; curr = tree.node( curr ).fNextSibling )
         {
-            if ( curr->fIsDir )
+            if ( tree.isDir( curr ) )
                 continue;
 
-            addFile( curr->fRelToDir );
+            auto path = dirPath;
+            addFile( path.append( tree.name( curr ) ) );
         }
 
         bool srcFound = false;
-        for ( auto && ii : fileInfo->fPairedChildDirectores )
+        for ( auto curr = tree.node( index ).fFirstChild; curr != -1; curr = tree.node( curr ).fNextSibling )
         {
-            if ( ii->fRelToDir.endsWith( "src" ) )
+            if ( !tree.hasFlag( curr, SFlatSourceNode::eIsPairedInclSrcDir ) )
+                continue;
+            if ( tree.name( curr ).endsWith( "src" ) )
                 srcFound = true;
-            getFiles( ii );
+            getFiles( tree, curr );
         }
         if ( srcFound )
             fIsPairedDir = true;
     }
 
-    bool SDirInfo::isBuildFile( const QString & path ) const
+    void SDirInfo::addFile( const QString & path )
     {
-        QFileInfo fi( path );
-        auto fn = fi.fileName().toLower();
-        auto suffix = fi.suffix().toLower();
-        if ( suffix == "mk" )
-            return true;
-        if ( fn == "makefile" || fn == "makefile.inc" )
-            return true;
-        return false;
+        switch ( CFileClassifier::fileType( path ) )
+        {
+            case EFileType::eUI:
+                fUIFiles << path;
+                break;
+            case EFileType::eQRC:
+                fQRCFiles << path;
+                break;
+            case EFileType::eYAML:
+                fYAMLFiles << path;
+                break;
+            case EFileType::eHeader:
+                fHeaderFiles << path;
+                break;
+            case EFileType::eSource:
+                fSourceFiles << path;
+                break;
+            case EFileType::eBuild:
+                fBuildFiles << path;
+                break;
+            case EFileType::eOther:
+                fOtherFiles << path;
+                break;
+        }
     }
 
-    void SDirInfo::addFile( const QString & path )
+    void SDirInfo::removeFiles( const std::function< bool( const QString & path ) > & isExcluded )
     {
-        static std::unordered_set< QString > headerSuffixes =
-        {
-            "h", "hh", "hpp", "hxx"
-        };
-        static std::unordered_set< QString > sourceSuffixes =
+        for ( auto && files : { &fSourceFiles, &fHeaderFiles, &fYAMLFiles, &fUIFiles, &fQRCFiles, &fBuildFiles, &fOtherFiles } )
         {
-            "c", "cxx", "cpp"
-        };
-        QFileInfo fi( path );
-        auto suffix = fi.suffix().toLower();
-        if ( suffix == "ui" )
-            fUIFiles << path;
-        else if ( suffix == "qrc" )
-            fQRCFiles << path;
-        else if ( suffix == "yaml" )
-            fYAMLFiles << path;
-        else if ( headerSuffixes.find( suffix ) != headerSuffixes.end() )
-            fHeaderFiles << path;
-        else if ( sourceSuffixes.find( suffix ) != sourceSuffixes.end() )
-            fSourceFiles << path;
-        else if ( isBuildFile( path ) )
-            fBuildFiles << path;
-        else
-            fOtherFiles << path;
+            for ( auto ii = files->begin(); ii != files->end(); )
+            {
+                if ( isExcluded( *ii ) )
+                    ii = files->erase( ii );
+                else
+                    ++ii;
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -27,6 +27,7 @@
 #include <QString>
 #include <QStringList>
 #include <memory>
+#include <functional>
 
 class QWidget;
 class QTextStream;
@@ -35,11 +36,12 @@ namespace NVSProjectMaker
 {
     class CSettings;
     struct SDebugTarget;
-    struct SSourceFileInfo;
+    struct SPchRecommendation;
+    class CFlatSourceTree;
     struct SDirInfo
     {
         SDirInfo() {}
-        SDirInfo( const std::shared_ptr< SSourceFileInfo > & fileInfo );
+        SDirInfo( const CFlatSourceTree & tree, int index );
         bool isValid() const;
         void writeCMakeFile( QWidget * parent, const CSettings * settings ) const;
         void writePropSheet( QWidget * parent, const CSettings * settings ) const;
@@ -53,9 +55,9 @@ namespace NVSProjectMaker
 
         QStringList getSubDirs() const;
         void replaceFiles( QString & text, const QString & variable, const QStringList & files ) const;
+        QString getPchHeaders() const;
         void addDependencies( QTextStream & qts ) const;
-        void computeRelToDir( const std::shared_ptr< SSourceFileInfo > & fileInfo );
-        bool isBuildFile( const QString & path ) const;
+        void computeRelToDir( const QString & relToDir );
 
         static QString getBuildItShellCmd( const QString & buildItFile );
 
@@ -79,9 +81,11 @@ namespace NVSProjectMaker
 
         QStringList fExtraTargets;
         std::list<SDebugTarget> fDebugCommands;
+        std::shared_ptr< SPchRecommendation > fPchRecommendation; // null unless the recommender ran
 
-        void getFiles( const std::shared_ptr< SSourceFileInfo > & fileInfo );
+        void getFiles( const CFlatSourceTree & tree, int index );
         void addFile( const QString & path );
+        void removeFiles( const std::function< bool( const QString & path ) > & isExcluded );
     };
 
 }
@@ -0,0 +1,150 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ExecJournalReader.h"
+#include "ExecRecorder/ExecJournal.h"
+
+#include <QObject>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+
+namespace NVSProjectMaker
+{
+    QString SExecJournalEntry::commandLine() const
+    {
+        auto program = fExecutable;
+        if ( !program.contains( '/' ) )
+        {
+            // execvp and posix_spawnp record the name before the PATH lookup
+            auto found = QStandardPaths::findExecutable( program );
+            if ( !found.isEmpty() )
+                program = found;
+        }
+
+        QStringList retVal;
+        retVal << program;
+        for ( int ii = 1; ii < fArgs.count(); ++ii )
+        {
+            auto arg = fArgs[ ii ];
+            if ( arg.contains( QRegularExpression( "\\s" ) ) )
+                arg = "\"" + arg + "\"";
+            retVal << arg;
+        }
+        return retVal.join( " " );
+    }
+
+    CExecJournalReader::CExecJournalReader( const QString & dirName ) :
+        fDirName( dirName )
+    {
+    }
+
+    bool CExecJournalReader::isJournalDir( const QString & path )
+    {
+        QFileInfo fi( path );
+        if ( !fi.isDir() )
+            return false;
+        return !QDir( path ).entryList( QStringList() << ( "*" EXEC_JOURNAL_SUFFIX ), QDir::Files ).isEmpty();
+    }
+
+    bool CExecJournalReader::open()
+    {
+        auto dir = QDir( fDirName );
+        auto journals = dir.entryList( QStringList() << ( "*" EXEC_JOURNAL_SUFFIX ), QDir::Files | QDir::Readable );
+        if ( journals.isEmpty() )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "'%1' holds no exec journals" ).arg( fDirName ) );
+            return false;
+        }
+
+        for ( auto && ii : journals )
+            fSize += QFileInfo( dir.absoluteFilePath( ii ) ).size();
+
+        for ( auto && ii : journals )
+        {
+            if ( !loadJournal( dir.absoluteFilePath( ii ) ) )
+                return false;
+        }
+
+        // every process has its own journal, the start time puts them back in one sequence
+        std::stable_sort( fEntries.begin(), fEntries.end(), []( const SExecJournalEntry & lhs, const SExecJournalEntry & rhs ) { return lhs.fTimeNS < rhs.fTimeNS; } );
+        fStatus = std::make_pair( true, QString() );
+        return true;
+    }
+
+    bool CExecJournalReader::loadJournal( const QString & fileName )
+    {
+        QFile file( fileName );
+        if ( !file.open( QFile::ReadOnly ) )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "Could not open '%1' for reading: %2" ).arg( fileName ).arg( file.errorString() ) );
+            return false;
+        }
+
+        auto data = file.readAll();
+        int pos = 0;
+        while ( ( pos + static_cast< int >( sizeof( SExecJournalRecord ) ) ) <= data.size() )
+        {
+            SExecJournalRecord header;
+            memcpy( &header, data.constData() + pos, sizeof( header ) );
+            if ( ( header.fMagic != EXEC_JOURNAL_MAGIC ) || ( header.fSize < sizeof( header ) ) || ( ( pos + static_cast< qint64 >( header.fSize ) ) > data.size() ) )
+                break; // a process killed in the middle of a write, the records before it are still good
+
+            SExecJournalEntry entry;
+            entry.fTimeNS = header.fTimeNS;
+            entry.fPid = header.fPid;
+
+            auto curr = data.constData() + pos + sizeof( header );
+            auto end = data.constData() + pos + header.fSize;
+            auto nextString = [&curr, end]()
+            {
+                auto len = strnlen( curr, end - curr );
+                auto retVal = QString::fromLocal8Bit( curr, static_cast< int >( len ) );
+                curr = std::min( end, curr + len + 1 );
+                return retVal;
+            };
+            entry.fExecutable = nextString();
+            entry.fWorkingDir = nextString();
+            for ( quint32 ii = 0; ( ii < header.fArgc ) && ( curr < end ); ++ii )
+                entry.fArgs << nextString();
+            fEntries.push_back( entry );
+
+            pos += header.fSize;
+            fPos += header.fSize;
+        }
+        return true;
+    }
+
+    bool CExecJournalReader::readEntry( SExecJournalEntry & entry )
+    {
+        if ( fNextEntry >= fEntries.size() )
+            return false;
+        entry = fEntries[ fNextEntry++ ];
+        return true;
+    }
+}
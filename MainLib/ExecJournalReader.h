@@ -0,0 +1,78 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __EXECJOURNALREADER_H
+#define __EXECJOURNALREADER_H
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    // one program started during the build, as recorded by the ExecRecorder LD_PRELOAD library
+    struct SExecJournalEntry
+    {
+        QString commandLine() const; // the executable and arguments, in the form the build output loaders match
+
+        quint64 fTimeNS{ 0 };
+        int fPid{ 0 };
+        QString fExecutable; // as passed to exec, not resolved against PATH for the execvp forms
+        QString fWorkingDir;
+        QStringList fArgs; // argv, including argv[ 0 ]
+    };
+
+    // Reads the *.jrnl files the ExecRecorder writes into a journal directory and returns the
+    // recorded programs in the order they were started.
+    class CExecJournalReader
+    {
+    public:
+        CExecJournalReader( const QString & dirName );
+
+        bool open();
+
+        bool status() const { return fStatus.first; }
+        QString errorString() const { return fStatus.second; }
+
+        qint64 size() const { return fSize; } // of all the journals
+        qint64 pos() const { return fPos; } // safe to call from any thread
+
+        bool readEntry( SExecJournalEntry & entry );
+
+        static bool isJournalDir( const QString & path );
+    private:
+        bool loadJournal( const QString & fileName );
+
+        QString fDirName;
+        std::vector< SExecJournalEntry > fEntries;
+        size_t fNextEntry{ 0 };
+        qint64 fSize{ 0 };
+        std::atomic< qint64 > fPos{ 0 };
+
+        std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
+    };
+}
+
+#endif
@@ -0,0 +1,251 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __FILECLASSIFIER_H
+#define __FILECLASSIFIER_H
+
+#include <QStringView>
+#include <cstddef>
+#include <cstdint>
+
+namespace NVSProjectMaker
+{
+    enum class EFileType
+    {
+        eOther,
+        eSource,
+        eHeader,
+        eUI,
+        eQRC,
+        eYAML,
+        eBuild
+    };
+
+    namespace NFileClassifier
+    {
+        struct SSuffixEntry
+        {
+            const char * fKey;
+            EFileType fType;
+            bool fMarksInclDir; // the presence of the file makes the directory an include directory
+        };
+
+        constexpr char16_t toLowerAscii( char16_t ch )
+        {
+            return ( ch >= u'A' && ch <= u'Z' ) ? static_cast< char16_t >( ch - u'A' + u'a' ) : ch;
+        }
+
+        constexpr size_t length( const char * str )
+        {
+            size_t retVal = 0;
+            while ( str[ retVal ] )
+                ++retVal;
+            return retVal;
+        }
+
+        template< typename TChar >
+        constexpr uint32_t hash( uint32_t seed, const TChar * str, size_t len )
+        {
+            uint32_t retVal = 2166136261u ^ seed;
+            for ( size_t ii = 0; ii < len; ++ii )
+            {
+                retVal ^= toLowerAscii( static_cast< char16_t >( str[ ii ] ) );
+                retVal *= 16777619u;
+            }
+            // fold the high bits down, so the slot index depends on the whole hash
+            retVal ^= retVal >> 16;
+            retVal *= 0x85ebca6bu;
+            retVal ^= retVal >> 13;
+            retVal *= 0xc2b2ae35u;
+            retVal ^= retVal >> 16;
+            return retVal;
+        }
+
+        // A perfect hash table over a fixed set of keys, the seed is searched for and the
+        // slots are filled at compile time.  Lookups are case insensitive (ASCII only) and never
+        // allocate, so a single table can be shared by any number of threads.
+        template< size_t N, size_t M >
+        class CPerfectHashTable
+        {
+        public:
+            constexpr CPerfectHashTable( const SSuffixEntry( &entries )[ N ] ) :
+                fSlots{}
+            {
+                static_assert( M >= N, "Table must have at least one slot per key" );
+                for ( uint32_t seed = 1; ; ++seed )
+                {
+                    if ( tryPlace( entries, seed ) )
+                    {
+                        fSeed = seed;
+                        break;
+                    }
+                }
+            }
+
+            constexpr const SSuffixEntry * find( const char16_t * str, size_t len ) const
+            {
+                if ( !len )
+                    return nullptr;
+                auto && slot = fSlots[ hash( fSeed, str, len ) % M ];
+                if ( !slot.fKey || ( length( slot.fKey ) != len ) )
+                    return nullptr;
+                for ( size_t ii = 0; ii < len; ++ii )
+                {
+                    if ( toLowerAscii( str[ ii ] ) != static_cast< char16_t >( slot.fKey[ ii ] ) )
+                        return nullptr;
+                }
+                return &slot;
+            }
+        private:
+            constexpr bool tryPlace( const SSuffixEntry( &entries )[ N ], uint32_t seed )
+            {
+                for ( size_t ii = 0; ii < M; ++ii )
+                    fSlots[ ii ] = SSuffixEntry{ nullptr, EFileType::eOther, false };
+                for ( size_t ii = 0; ii < N; ++ii )
+                {
+                    auto && slot = fSlots[ hash( seed, entries[ ii ].fKey, length( entries[ ii ].fKey ) ) % M ];
+                    if ( slot.fKey )
+                        return false;
+                    slot = entries[ ii ];
+                }
+                return true;
+            }
+
+            uint32_t fSeed{ 0 };
+            SSuffixEntry fSlots[ M ];
+        };
+
+        // keys are lower case
+        constexpr SSuffixEntry kSuffixEntries[] =
+        {
+             { "h", EFileType::eHeader, true }
+            ,{ "hh", EFileType::eHeader, true }
+            ,{ "hpp", EFileType::eHeader, true }
+            ,{ "hxx", EFileType::eHeader, false }
+            ,{ "c", EFileType::eSource, false }
+            ,{ "cxx", EFileType::eSource, false }
+            ,{ "cpp", EFileType::eSource, false }
+            ,{ "ui", EFileType::eUI, false }
+            ,{ "qrc", EFileType::eQRC, false }
+            ,{ "yaml", EFileType::eYAML, false }
+            ,{ "mk", EFileType::eBuild, false }
+        };
+        constexpr CPerfectHashTable< sizeof( kSuffixEntries ) / sizeof( SSuffixEntry ), 16 > kSuffixTable{ kSuffixEntries };
+
+        constexpr SSuffixEntry kFileNameEntries[] =
+        {
+             { "makefile", EFileType::eBuild, false }
+            ,{ "makefile.inc", EFileType::eBuild, false }
+        };
+        constexpr CPerfectHashTable< sizeof( kFileNameEntries ) / sizeof( SSuffixEntry ), 4 > kFileNameTable{ kFileNameEntries };
+
+        // complete suffixes (everything after the first '.') of files a build log treats as primary sources,
+        // the moc, uic and rcc outputs among them are found through the items that generate them
+        constexpr SSuffixEntry kBuildLogSourceEntries[] =
+        {
+             { "c", EFileType::eSource, false }
+            ,{ "obf.c", EFileType::eSource, false }
+            ,{ "sdf.c", EFileType::eSource, false }
+            ,{ "cpp", EFileType::eSource, false }
+            ,{ "cxx", EFileType::eSource, false }
+            ,{ "h", EFileType::eHeader, false }
+            ,{ "ui", EFileType::eUI, false }
+            ,{ "qrc", EFileType::eQRC, false }
+        };
+        constexpr CPerfectHashTable< sizeof( kBuildLogSourceEntries ) / sizeof( SSuffixEntry ), 16 > kBuildLogSourceTable{ kBuildLogSourceEntries };
+
+        // the path helpers follow QFileInfo::fileName, suffix and completeSuffix, with either separator
+        constexpr size_t fileNamePos( const char16_t * path, size_t len )
+        {
+            for ( size_t ii = len; ii > 0; --ii )
+            {
+                if ( ( path[ ii - 1 ] == u'/' ) || ( path[ ii - 1 ] == u'\\' ) )
+                    return ii;
+            }
+            return 0;
+        }
+
+        constexpr size_t suffixPos( const char16_t * path, size_t len, bool complete )
+        {
+            auto start = fileNamePos( path, len );
+            if ( complete )
+            {
+                for ( size_t ii = start; ii < len; ++ii )
+                {
+                    if ( path[ ii ] == u'.' )
+                        return ii + 1;
+                }
+            }
+            else
+            {
+                for ( size_t ii = len; ii > start; --ii )
+                {
+                    if ( path[ ii - 1 ] == u'.' )
+                        return ii;
+                }
+            }
+            return len;
+        }
+
+        constexpr EFileType fileType( const char16_t * path, size_t len )
+        {
+            auto pos = suffixPos( path, len, false );
+            if ( auto entry = kSuffixTable.find( path + pos, len - pos ) )
+                return entry->fType;
+
+            pos = fileNamePos( path, len );
+            if ( auto entry = kFileNameTable.find( path + pos, len - pos ) )
+                return entry->fType;
+            return EFileType::eOther;
+        }
+
+        constexpr bool marksInclDir( const char16_t * path, size_t len )
+        {
+            auto pos = suffixPos( path, len, false );
+            auto entry = kSuffixTable.find( path + pos, len - pos );
+            return entry && entry->fMarksInclDir;
+        }
+
+        constexpr bool isBuildLogSourceFile( const char16_t * path, size_t len )
+        {
+            auto pos = suffixPos( path, len, true );
+            return kBuildLogSourceTable.find( path + pos, len - pos ) != nullptr;
+        }
+    }
+
+    // Classifies files by name only, without touching the file system.  Used by the source
+    // scanner (include directory detection), the project generator (SDirInfo) and the build
+    // log parser (CBuildInfoData), all of which may call it from several threads at once.
+    class CFileClassifier
+    {
+    public:
+        static EFileType fileType( QStringView path ) { return NFileClassifier::fileType( path.utf16(), static_cast< size_t >( path.size() ) ); }
+        static bool isBuildFile( QStringView path ) { return fileType( path ) == EFileType::eBuild; }
+        static bool isHeaderFile( QStringView path ) { return fileType( path ) == EFileType::eHeader; }
+        static bool isSourceFile( QStringView path ) { return fileType( path ) == EFileType::eSource; }
+        static bool marksInclDir( QStringView path ) { return NFileClassifier::marksInclDir( path.utf16(), static_cast< size_t >( path.size() ) ); }
+        static bool isBuildLogSourceFile( QStringView path ) { return NFileClassifier::isBuildLogSourceFile( path.utf16(), static_cast< size_t >( path.size() ) ); }
+    };
+}
+
+#endif
@@ -0,0 +1,251 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "FlagFactoring.h"
+#include "BuildInfoData.h"
+
+#include <QObject>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace NVSProjectMaker
+{
+    int SFlagFactoring::numFactoredFlags() const
+    {
+        auto retVal = fCommonFlags.count();
+        for ( auto && ii : fDeltas )
+            retVal += ii.second.count();
+        return retVal;
+    }
+
+    QString SFlagFactoring::getText() const
+    {
+        QStringList retVal;
+        retVal << QObject::tr( "%1: Items: %2 Flags: %3 Factored: %4" ).arg( fName ).arg( fNumItems ).arg( fNumFlags ).arg( numFactoredFlags() );
+        retVal << QObject::tr( "    Common: %1" ).arg( fCommonFlags.join( " " ) );
+        for ( auto && ii : fDeltas )
+            retVal << QString( "    %1: %2" ).arg( ii.first->firstSrcFile() ).arg( ii.second.join( " " ) );
+        return retVal.join( "\n" );
+    }
+
+    // the flags of one option, options() hands the options over sorted by name, so only the values
+    // of a list option (/I, /D...) keep their command line order, the unknown options are kept
+    // together as one unordered group
+    struct SOptionFlags
+    {
+        QString fOption;
+        bool fOrdered{ false };
+        QStringList fFlags;
+    };
+
+    static std::list< SOptionFlags > optionFlags( const std::shared_ptr< SCompileItem > & item )
+    {
+        std::list< SOptionFlags > retVal;
+        if ( !item )
+            return retVal;
+
+        auto prefix = std::dynamic_pointer_cast< SVSCLCompileItem >( item ) ? QString( "/" ) : QString( "-" );
+        auto targetOption = item->targetFileOption();
+        for ( auto && ii : item->options() )
+        {
+            if ( ii.first == targetOption )
+                continue;
+            auto && value = std::get< 2 >( ii.second );
+            if ( !value.has_value() )
+                continue;
+
+            SOptionFlags curr;
+            curr.fOption = ii.first;
+            auto name = prefix + ii.first + ( std::get< 1 >( ii.second ) ? ":" : "" );
+            switch ( std::get< 0 >( ii.second ) )
+            {
+                case EOptionType::eBool:
+                    curr.fFlags << ( std::get< 0 >( value.value() ) ? ( prefix + ii.first ) : ( prefix + ii.first + "-" ) );
+                    break;
+                case EOptionType::eString:
+                    curr.fFlags << name + std::get< 1 >( value.value() );
+                    break;
+                case EOptionType::eStringList:
+                    curr.fOrdered = true;
+                    for ( auto && jj : std::get< 2 >( value.value() ) )
+                        curr.fFlags << name + jj;
+                    break;
+            }
+            retVal.push_back( curr );
+        }
+        if ( !item->fOtherOptions.isEmpty() )
+            retVal.push_back( { QString(), false, item->fOtherOptions } );
+        return retVal;
+    }
+
+    QStringList CFlagFactoring::itemFlags( const std::shared_ptr< SCompileItem > & item )
+    {
+        QStringList retVal;
+        for ( auto && ii : optionFlags( item ) )
+            retVal << ii.fFlags;
+        return retVal;
+    }
+
+    SFlagFactoring CFlagFactoring::factor( const QString & name, const std::list< std::shared_ptr< SCompileItem > > & items )
+    {
+        SFlagFactoring retVal;
+        retVal.fName = name;
+        retVal.fNumItems = static_cast< int >( items.size() );
+        if ( items.empty() )
+            return retVal;
+
+        std::list< std::list< SOptionFlags > > flags;
+        std::unordered_map< QString, int > counts;
+        std::unordered_map< QString, int > orderedCommon; // by option, the length of the values every item starts with
+        for ( auto && ii : items )
+        {
+            flags.push_back( optionFlags( ii ) );
+
+            // a flag repeated on one command line still only counts once for that item
+            std::unordered_set< QString > seen;
+            std::unordered_set< QString > ordered;
+            for ( auto && jj : flags.back() )
+            {
+                retVal.fNumFlags += jj.fFlags.count();
+                if ( jj.fOrdered )
+                {
+                    ordered.insert( jj.fOption );
+                    auto pos = orderedCommon.find( jj.fOption );
+                    if ( flags.size() == 1 )
+                        orderedCommon[ jj.fOption ] = jj.fFlags.count();
+                    else if ( pos != orderedCommon.end() )
+                    {
+                        auto && firstFlags = std::find_if( flags.front().begin(), flags.front().end(), [&jj]( const SOptionFlags & curr ) { return curr.fOption == jj.fOption; } )->fFlags;
+                        int len = 0;
+                        while ( ( len < ( *pos ).second ) && ( len < jj.fFlags.count() ) && ( jj.fFlags[ len ] == firstFlags[ len ] ) )
+                            len++;
+                        ( *pos ).second = len;
+                    }
+                    continue;
+                }
+                for ( auto && kk : jj.fFlags )
+                {
+                    if ( seen.insert( kk ).second )
+                        counts[ kk ]++;
+                }
+            }
+            // a list option missing from an item has nothing in common
+            for ( auto && jj : orderedCommon )
+            {
+                if ( ordered.find( jj.first ) == ordered.end() )
+                    jj.second = 0;
+            }
+        }
+
+        // the common flags keep the order of the first item, and a list option only shares the values
+        // every item starts with, so the common flags followed by an item's delta hold all of its flags
+        // with every list option's values in their command line order
+        std::unordered_set< QString > common;
+        for ( auto && ii : flags.front() )
+        {
+            if ( ii.fOrdered )
+            {
+                retVal.fCommonFlags << ii.fFlags.mid( 0, orderedCommon[ ii.fOption ] );
+                continue;
+            }
+            for ( auto && jj : ii.fFlags )
+            {
+                if ( ( counts[ jj ] == retVal.fNumItems ) && common.insert( jj ).second )
+                    retVal.fCommonFlags << jj;
+            }
+        }
+
+        auto pos = flags.begin();
+        for ( auto && ii : items )
+        {
+            QStringList delta;
+            for ( auto && jj : *pos )
+            {
+                if ( jj.fOrdered )
+                {
+                    delta << jj.fFlags.mid( orderedCommon[ jj.fOption ] );
+                    continue;
+                }
+                for ( auto && kk : jj.fFlags )
+                {
+                    if ( common.find( kk ) == common.end() )
+                        delta << kk;
+                }
+            }
+            if ( !delta.isEmpty() )
+                retVal.fDeltas.push_back( std::make_pair( ii, delta ) );
+            ++pos;
+        }
+        return retVal;
+    }
+
+    std::list< SFlagFactoring > CFlagFactoring::byDirectory( const CBuildInfoData & data )
+    {
+        std::list< SFlagFactoring > retVal;
+        for ( auto && ii : data.directories() )
+        {
+            auto && dirItem = ii.second;
+            if ( !dirItem->fVSCLCompiledFiles.empty() )
+                retVal.push_back( factor( dirItem->fDir + " (CL)", std::list< std::shared_ptr< SCompileItem > >( dirItem->fVSCLCompiledFiles.begin(), dirItem->fVSCLCompiledFiles.end() ) ) );
+            if ( !dirItem->fGccCompiledFiles.empty() )
+                retVal.push_back( factor( dirItem->fDir + " (GCC)", std::list< std::shared_ptr< SCompileItem > >( dirItem->fGccCompiledFiles.begin(), dirItem->fGccCompiledFiles.end() ) ) );
+        }
+        return retVal;
+    }
+
+    std::list< SFlagFactoring > CFlagFactoring::byTarget( const CBuildInfoData & data )
+    {
+        std::list< SFlagFactoring > retVal;
+        for ( auto && ii : data.items() )
+        {
+            if ( !std::dynamic_pointer_cast< SLibraryItem >( ii ) && !std::dynamic_pointer_cast< SExecItem >( ii ) )
+                continue;
+
+            std::list< std::shared_ptr< SCompileItem > > compileItems;
+            for ( auto && jj : ii->fDependencyItems )
+            {
+                if ( auto compileItem = std::dynamic_pointer_cast< SCompileItem >( jj ) )
+                    compileItems.push_back( compileItem );
+            }
+            if ( !compileItems.empty() )
+                retVal.push_back( factor( ii->targetFile(), compileItems ) );
+        }
+        return retVal;
+    }
+
+    QString CFlagFactoring::getText( const std::list< SFlagFactoring > & results )
+    {
+        QStringList retVal;
+        int numFlags = 0;
+        int numFactored = 0;
+        for ( auto && ii : results )
+        {
+            retVal << ii.getText();
+            numFlags += ii.fNumFlags;
+            numFactored += ii.numFactoredFlags();
+        }
+        retVal << QObject::tr( "Groups: %1 Flags: %2 Factored: %3" ).arg( static_cast< int >( results.size() ) ).arg( numFlags ).arg( numFactored );
+        return retVal.join( "\n" );
+    }
+}
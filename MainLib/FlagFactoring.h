@@ -0,0 +1,68 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __FLAGFACTORING_H
+#define __FLAGFACTORING_H
+
+#include <QString>
+#include <QStringList>
+#include <list>
+#include <memory>
+
+namespace NVSProjectMaker
+{
+    class CBuildInfoData;
+    struct SCompileItem;
+
+    // The flags every compile item of a group shares, and what each item adds on top of them
+    struct SFlagFactoring
+    {
+        QString fName; // the directory and compiler, or the link target
+        QStringList fCommonFlags;
+        std::list< std::pair< std::shared_ptr< SCompileItem >, QStringList > > fDeltas; // only the items with flags beyond the common ones
+        int fNumItems{ 0 };
+        int fNumFlags{ 0 }; // summed over the items, before factoring
+
+        int numFactoredFlags() const;
+        QString getText() const;
+    };
+
+    // Splits the options of a group of compile items into their intersection and the per item
+    // deltas.  Each pass is a count over a hash of the flag strings, so a group costs time linear
+    // in its flags.  The options are handled in name order, not command line order.  The values of a
+    // list option, such as /I or -D, keep their command line order and are only shared up to where
+    // the items' orders differ, so the common flags followed by an item's delta hold all of its flags.
+    class CFlagFactoring
+    {
+    public:
+        static QStringList itemFlags( const std::shared_ptr< SCompileItem > & item ); // the item's options, without its sources and object file
+        static SFlagFactoring factor( const QString & name, const std::list< std::shared_ptr< SCompileItem > > & items );
+
+        static std::list< SFlagFactoring > byDirectory( const CBuildInfoData & data ); // one group per directory and compiler
+        static std::list< SFlagFactoring > byTarget( const CBuildInfoData & data ); // one group per library or executable
+
+        static QString getText( const std::list< SFlagFactoring > & results );
+    };
+}
+
+#endif
@@ -0,0 +1,130 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "FlatSourceTree.h"
+#include "Settings.h"
+
+#include <algorithm>
+
+namespace NVSProjectMaker
+{
+    CFlatSourceTree::CFlatSourceTree( const std::shared_ptr< SSourceFileInfo > & root )
+    {
+        struct SFrame
+        {
+            int fIndex;
+            std::list< std::shared_ptr< SSourceFileInfo > >::const_iterator fNext;
+            std::list< std::shared_ptr< SSourceFileInfo > >::const_iterator fEnd;
+            int fLastChild;
+        };
+
+        addNode( root, -1 );
+        std::vector< SFrame > stack = { { 0, root->fChildren.begin(), root->fChildren.end(), -1 } };
+        while ( !stack.empty() )
+        {
+            auto && frame = stack.back();
+            if ( frame.fNext == frame.fEnd )
+            {
+                stack.pop_back();
+                continue;
+            }
+
+            auto child = *frame.fNext++;
+            auto index = addNode( child, frame.fIndex );
+            if ( frame.fLastChild == -1 )
+                fNodes[ frame.fIndex ].fFirstChild = index;
+            else
+                fNodes[ frame.fLastChild ].fNextSibling = index;
+            frame.fLastChild = index;
+
+            // the child's subtree is laid out before its next sibling
+            if ( child->fIsDir && !child->fChildren.empty() )
+                stack.push_back( { index, child->fChildren.begin(), child->fChildren.end(), -1 } );
+        }
+    }
+
+    int CFlatSourceTree::addNode( const std::shared_ptr< SSourceFileInfo > & info, int parent )
+    {
+        SFlatSourceNode node;
+        node.fParent = parent;
+        node.fNameOffset = static_cast< quint32 >( fNamePool.length() );
+        node.fNameLength = static_cast< quint16 >( info->fName.length() );
+        fNamePool.append( info->fName );
+        if ( info->fIsDir )
+        {
+            node.fFlags |= SFlatSourceNode::eIsDir;
+            if ( info->fIsBuildDir )
+                node.fFlags |= SFlatSourceNode::eIsBuildDir;
+            if ( info->fIsIncludeDir )
+                node.fFlags |= SFlatSourceNode::eIsIncludeDir;
+            node.fDir = static_cast< int >( fDirs.size() );
+            fDirs.push_back( info );
+        }
+        fNodes.push_back( node );
+        return static_cast< int >( fNodes.size() ) - 1;
+    }
+
+    int CFlatSourceTree::subtreeEnd( int index ) const
+    {
+        for ( auto curr = index; curr != -1; curr = fNodes[ curr ].fParent )
+        {
+            if ( fNodes[ curr ].fNextSibling != -1 )
+                return fNodes[ curr ].fNextSibling;
+        }
+        return size();
+    }
+
+    QString CFlatSourceTree::relPath( int index ) const
+    {
+        int length = -1;
+        for ( auto curr = index; curr > 0; curr = fNodes[ curr ].fParent )
+            length += fNodes[ curr ].fNameLength + 1;
+        if ( length <= 0 )
+            return {};
+
+        QString retVal( length, '/' );
+        auto out = retVal.data() + length;
+        for ( auto curr = index; curr > 0; curr = fNodes[ curr ].fParent )
+        {
+            auto && node = fNodes[ curr ];
+            out -= node.fNameLength;
+            std::copy( fNamePool.constData() + node.fNameOffset, fNamePool.constData() + node.fNameOffset + node.fNameLength, out );
+            if ( node.fParent > 0 )
+                out--; // the separator is already in place
+        }
+        return retVal;
+    }
+
+    const std::list< std::pair< QString, bool > > & CFlatSourceTree::executables( int index ) const
+    {
+        static const std::list< std::pair< QString, bool > > sNone;
+        auto dir = fNodes[ index ].fDir;
+        return ( dir == -1 ) ? sNone : fDirs[ dir ]->fExecutables;
+    }
+
+    std::shared_ptr< SSourceFileInfo > CFlatSourceTree::sourceInfo( int index ) const
+    {
+        auto dir = fNodes[ index ].fDir;
+        return ( dir == -1 ) ? std::shared_ptr< SSourceFileInfo >() : fDirs[ dir ];
+    }
+}
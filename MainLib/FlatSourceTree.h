@@ -0,0 +1,93 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __FLATSOURCETREE_H
+#define __FLATSOURCETREE_H
+
+#include <QString>
+#include <QStringRef>
+#include <QtGlobal>
+#include <list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    struct SSourceFileInfo;
+
+    // One node of CFlatSourceTree, the links are indices into its node vector and the name is a
+    // range of its string pool, so a node is 24 bytes with no allocation of its own.
+    struct SFlatSourceNode
+    {
+        enum EFlags : quint16
+        {
+            eIsDir = 0x01,
+            eIsBuildDir = 0x02,
+            eIsIncludeDir = 0x04,
+            eIsPairedInclSrcDir = 0x08, // set by CSettings::getParentOfPairDirectoriesMap
+            eIsParentToPairedDirs = 0x10 // likewise
+        };
+
+        qint32 fParent{ -1 };
+        qint32 fFirstChild{ -1 };
+        qint32 fNextSibling{ -1 };
+        qint32 fDir{ -1 }; // into the per directory data, -1 for files
+        quint32 fNameOffset{ 0 };
+        quint16 fNameLength{ 0 };
+        quint16 fFlags{ 0 };
+    };
+
+    // The scanned source tree laid out in one vector in depth first order, so the passes that
+    // generate the projects are linear scans, and every subtree is a contiguous range of nodes.
+    // Index 0 is the source dir itself.  It is built from the SSourceFileInfo tree, which the scan,
+    // the watcher and the GUI still use, and keeps that tree alive for sourceInfo.
+    class CFlatSourceTree
+    {
+    public:
+        CFlatSourceTree( const std::shared_ptr< SSourceFileInfo > & root );
+
+        int size() const { return static_cast< int >( fNodes.size() ); }
+        int computeTotal() const { return size() - 1; } // every node below the source dir
+        const SFlatSourceNode & node( int index ) const { return fNodes[ index ]; }
+        int subtreeEnd( int index ) const; // one past the last node below index
+
+        bool hasFlag( int index, SFlatSourceNode::EFlags flag ) const { return ( fNodes[ index ].fFlags & flag ) != 0; }
+        void setFlag( int index, SFlatSourceNode::EFlags flag ) { fNodes[ index ].fFlags |= flag; }
+        bool isDir( int index ) const { return hasFlag( index, SFlatSourceNode::eIsDir ); }
+
+        QStringRef name( int index ) const { return QStringRef( &fNamePool, static_cast< int >( fNodes[ index ].fNameOffset ), fNodes[ index ].fNameLength ); }
+        QString relPath( int index ) const; // rebuilt from the names, empty for the source dir
+
+        const std::list< std::pair< QString, bool > > & executables( int index ) const;
+        std::shared_ptr< SSourceFileInfo > sourceInfo( int index ) const; // the scanned node of a directory, null for files
+    private:
+        int addNode( const std::shared_ptr< SSourceFileInfo > & info, int parent );
+
+        std::vector< SFlatSourceNode > fNodes;
+        std::vector< std::shared_ptr< SSourceFileInfo > > fDirs; // the scanned node of each directory
+        QString fNamePool;
+    };
+}
+
+#endif
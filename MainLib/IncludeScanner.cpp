@@ -0,0 +1,467 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "IncludeScanner.h"
+#include "FileClassifier.h"
+#include "Settings.h"
+
+#include <QApplication>
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QProgressDialog>
+
+#include <algorithm>
+#include <future>
+#include <thread>
+
+namespace NVSProjectMaker
+{
+    CIncludeScanner::CIncludeScanner( const CSettings * settings ) :
+        fResults( settings->getResults() ),
+        fSourceDir( settings->getSourceDir().value_or( QString() ) )
+    {
+        QDir sourceDir( fSourceDir );
+        for ( auto && ii : settings->getIncludeDirs() )
+        {
+            auto dir = QDir::cleanPath( QDir::isRelativePath( ii ) ? ii : sourceDir.relativeFilePath( ii ) );
+            if ( !dir.startsWith( ".." ) ) // outside the tree nothing can be found in memory
+                fInclDirs << ( ( dir == "." ) ? QString() : dir );
+        }
+    }
+
+    int SIncludeGraph::findFile( const QString & relPath ) const
+    {
+        auto pos = fFileIDs.find( relPath );
+        return ( pos == fFileIDs.end() ) ? -1 : ( *pos ).second;
+    }
+
+    QString SIncludeGraph::getText( int numTop ) const
+    {
+        int numEdges = 0;
+        int numUnresolved = 0;
+        for ( int ii = 0; ii < numFiles(); ++ii )
+        {
+            numEdges += static_cast< int >( fIncludes[ ii ].size() );
+            numUnresolved += fUnresolved[ ii ].count();
+        }
+
+        QStringList retVal;
+        retVal << QObject::tr( "Files: %1 Include Directives: %2 Resolved: %3 Unresolved: %4" ).arg( numFiles() ).arg( fNumDirectives ).arg( numEdges ).arg( numUnresolved );
+
+        auto addTop = [this, numTop, &retVal]( const QString & title, const std::vector< int > & values )
+        {
+            std::vector< int > order( values.size() );
+            for ( size_t ii = 0; ii < order.size(); ++ii )
+                order[ ii ] = static_cast< int >( ii );
+            auto num = std::min( static_cast< size_t >( std::max( numTop, 0 ) ), order.size() );
+            std::partial_sort( order.begin(), order.begin() + num, order.end(), [&values]( int lhs, int rhs ) { return values[ lhs ] > values[ rhs ]; } );
+            retVal << title;
+            for ( size_t ii = 0; ii < num; ++ii )
+                retVal << QString( "    %1: %2" ).arg( fFiles[ order[ ii ] ] ).arg( values[ order[ ii ] ] );
+        };
+        addTop( QObject::tr( "Most Included:" ), fFanIn );
+        addTop( QObject::tr( "Largest Include Closure:" ), fClosureSize );
+        return retVal.join( "\n" );
+    }
+
+    QString CIncludeScanner::pairedDir( const QString & dir )
+    {
+        auto pos = dir.lastIndexOf( '/' ) + 1;
+        auto name = dir.mid( pos );
+        if ( name == "src" )
+            return dir.left( pos ) + "incl";
+        if ( name == "incl" )
+            return dir.left( pos ) + "src";
+        return QString();
+    }
+
+    int CIncludeScanner::resolve( const SIncludeGraph & graph, const QString & fileDir, const SIncludeDirective & directive ) const
+    {
+        auto find = [&graph, &directive]( const QString & dir )
+        {
+            return graph.findFile( QDir::cleanPath( dir.isEmpty() ? directive.fName : ( dir + "/" + directive.fName ) ) );
+        };
+
+        int retVal = -1;
+        if ( !directive.fIsSystem )
+            retVal = find( fileDir );
+        auto peer = pairedDir( fileDir );
+        if ( ( retVal == -1 ) && !peer.isEmpty() )
+            retVal = find( peer );
+        for ( int ii = 0; ( retVal == -1 ) && ( ii < fInclDirs.count() ); ++ii )
+            retVal = find( fInclDirs[ ii ] );
+        return retVal;
+    }
+
+    bool CIncludeScanner::runParallel( size_t count, int numThreads, QProgressDialog * progress, const QString & label, const std::function< void( size_t ii, std::vector< int > & scratch ) > & func )
+    {
+        if ( progress )
+        {
+            progress->setLabelText( label );
+            progress->setRange( 0, static_cast< int >( count ) );
+            progress->setValue( 0 );
+        }
+
+        // the files are handed out one at a time, so a few large ones do not hold up a whole thread's share
+        std::atomic< size_t > next{ 0 };
+        std::atomic< size_t > numDone{ 0 };
+        std::atomic< bool > canceled{ false };
+        std::list< std::future< void > > workers;
+        for ( int ii = 0; ii < numThreads; ++ii )
+        {
+            workers.push_back( std::async( std::launch::async, [count, &func, &next, &numDone, &canceled]()
+            {
+                std::vector< int > scratch;
+                for ( auto curr = next++; !canceled && ( curr < count ); curr = next++ )
+                {
+                    func( curr, scratch );
+                    numDone++;
+                }
+            } ) );
+        }
+
+        for ( auto && ii : workers )
+        {
+            while ( ii.wait_for( std::chrono::milliseconds( 50 ) ) != std::future_status::ready )
+            {
+                if ( !progress )
+                    continue;
+                progress->setValue( static_cast< int >( numDone ) );
+                qApp->processEvents();
+                if ( progress->wasCanceled() )
+                    canceled = true;
+            }
+            ii.get();
+        }
+        return !canceled;
+    }
+
+    std::shared_ptr< SIncludeGraph > CIncludeScanner::scan( QProgressDialog * progress, int numThreads ) const
+    {
+        if ( numThreads <= 0 )
+            numThreads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency() ) );
+
+        auto retVal = std::make_shared< SIncludeGraph >();
+        CRelPathCache paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { fResults->fRootDir };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( ii->fIsDir )
+                    stack.push_back( ii );
+                else if ( CFileClassifier::isSourceFile( ii->fName ) || CFileClassifier::isHeaderFile( ii->fName ) )
+                {
+                    auto && relPath = paths.relPath( ii.get() );
+                    retVal->fFileIDs[ relPath ] = static_cast< int >( retVal->fFiles.size() );
+                    retVal->fFiles.push_back( relPath );
+                }
+            }
+        }
+
+        auto numFiles = retVal->fFiles.size();
+        retVal->fIncludes.resize( numFiles );
+        retVal->fUnresolved.resize( numFiles );
+        retVal->fFanIn.resize( numFiles, 0 );
+        retVal->fClosureSize.resize( numFiles, 0 );
+
+        // each file only writes its own slots, the lookup tables are read only by now.  QDir caches
+        // its absolute path on first use, so the workers only share the finished string
+        const QString root = QDir( fSourceDir ).absolutePath() + '/';
+        std::atomic< int > numDirectives{ 0 };
+        auto scanned = runParallel( numFiles, numThreads, progress, QObject::tr( "Scanning #include directives..." ), [this, &retVal, &root, &numDirectives]( size_t ii, std::vector< int > & /*scratch*/ )
+        {
+            auto && relPath = retVal->fFiles[ ii ];
+            QFile file( root + relPath );
+            if ( !file.open( QIODevice::ReadOnly ) )
+                return;
+            auto directives = findIncludes( file.readAll() );
+            numDirectives += static_cast< int >( directives.size() );
+
+            auto slashPos = relPath.lastIndexOf( '/' );
+            auto fileDir = ( slashPos == -1 ) ? QString() : relPath.left( slashPos );
+            for ( auto && jj : directives )
+            {
+                auto id = resolve( *retVal, fileDir, jj );
+                if ( id == -1 )
+                    retVal->fUnresolved[ ii ] << jj.fName;
+                else if ( id != static_cast< int >( ii ) )
+                    retVal->fIncludes[ ii ].push_back( id );
+            }
+        } );
+        if ( !scanned )
+            return {};
+        retVal->fNumDirectives = numDirectives;
+
+        for ( auto && ii : retVal->fIncludes )
+        {
+            // a header included twice, under guards, is still one edge
+            std::vector< int > unique;
+            unique.reserve( ii.size() );
+            for ( auto && jj : ii )
+            {
+                if ( std::find( unique.begin(), unique.end(), jj ) == unique.end() )
+                    unique.push_back( jj );
+            }
+            ii.swap( unique );
+            for ( auto && jj : ii )
+                retVal->fFanIn[ jj ]++;
+        }
+
+        // a walk per file, the scratch stamps which files the current walk has seen so nothing is cleared in between
+        auto closed = runParallel( numFiles, numThreads, progress, QObject::tr( "Computing include closures..." ), [&retVal, numFiles]( size_t ii, std::vector< int > & seen )
+        {
+            if ( seen.empty() )
+                seen.resize( numFiles, -1 );
+            auto stamp = static_cast< int >( ii );
+            seen[ ii ] = stamp;
+            int size = 0;
+            std::vector< int > pending = { stamp };
+            while ( !pending.empty() )
+            {
+                auto curr = pending.back();
+                pending.pop_back();
+                for ( auto && jj : retVal->fIncludes[ curr ] )
+                {
+                    if ( seen[ jj ] == stamp )
+                        continue;
+                    seen[ jj ] = stamp;
+                    size++;
+                    pending.push_back( jj );
+                }
+            }
+            retVal->fClosureSize[ ii ] = size;
+        } );
+        if ( !closed )
+            return {};
+        return retVal;
+    }
+
+    namespace
+    {
+        inline bool isSpace( char ch )
+        {
+            return ( ch == ' ' ) || ( ch == '\t' ) || ( ch == '\r' ) || ( ch == '\f' ) || ( ch == '\v' );
+        }
+
+        inline bool isIdentifier( char ch )
+        {
+            return ( ( ch >= 'a' ) && ( ch <= 'z' ) ) || ( ( ch >= 'A' ) && ( ch <= 'Z' ) ) || ( ( ch >= '0' ) && ( ch <= '9' ) ) || ( ch == '_' );
+        }
+
+        // a backslash newline joins two lines, with or without the \r
+        inline size_t continuationLength( const char * data, size_t len, size_t pos )
+        {
+            if ( ( data[ pos ] != '\\' ) || ( pos + 1 >= len ) )
+                return 0;
+            if ( data[ pos + 1 ] == '\n' )
+                return 2;
+            if ( ( data[ pos + 1 ] == '\r' ) && ( pos + 2 < len ) && ( data[ pos + 2 ] == '\n' ) )
+                return 3;
+            return 0;
+        }
+
+        size_t skipBlockComment( const char * data, size_t len, size_t pos )
+        {
+            for ( pos += 2; pos + 1 < len; ++pos )
+            {
+                if ( ( data[ pos ] == '*' ) && ( data[ pos + 1 ] == '/' ) )
+                    return pos + 2;
+            }
+            return len;
+        }
+
+        // stops on the newline that ends the logical line
+        size_t skipToEndOfLine( const char * data, size_t len, size_t pos )
+        {
+            while ( ( pos < len ) && ( data[ pos ] != '\n' ) )
+            {
+                if ( auto cont = continuationLength( data, len, pos ) )
+                    pos += cont;
+                else if ( ( data[ pos ] == '/' ) && ( pos + 1 < len ) && ( data[ pos + 1 ] == '*' ) )
+                    pos = skipBlockComment( data, len, pos );
+                else
+                    ++pos;
+            }
+            return pos;
+        }
+
+        size_t skipHorizontalSpace( const char * data, size_t len, size_t pos )
+        {
+            while ( pos < len )
+            {
+                if ( isSpace( data[ pos ] ) )
+                    ++pos;
+                else if ( auto cont = continuationLength( data, len, pos ) )
+                    pos += cont;
+                else if ( ( data[ pos ] == '/' ) && ( pos + 1 < len ) && ( data[ pos + 1 ] == '*' ) )
+                    pos = skipBlockComment( data, len, pos );
+                else
+                    break;
+            }
+            return pos;
+        }
+
+        // an unterminated literal ends with its line, like the compiler's error recovery
+        size_t skipLiteral( const char * data, size_t len, size_t pos )
+        {
+            auto quote = data[ pos++ ];
+            while ( ( pos < len ) && ( data[ pos ] != '\n' ) )
+            {
+                if ( data[ pos ] == '\\' )
+                    pos += 2;
+                else if ( data[ pos++ ] == quote )
+                    return pos;
+            }
+            return std::min( pos, len );
+        }
+
+        // R"delim( ... )delim", pos is on the opening quote
+        size_t skipRawString( const char * data, size_t len, size_t pos )
+        {
+            auto open = pos + 1;
+            auto paren = open;
+            while ( ( paren < len ) && ( data[ paren ] != '(' ) && ( data[ paren ] != '\n' ) && ( paren - open <= 16 ) )
+                ++paren;
+            if ( ( paren >= len ) || ( data[ paren ] != '(' ) )
+                return skipLiteral( data, len, pos );
+
+            auto delimLen = paren - open;
+            for ( auto curr = paren + 1; curr + delimLen + 1 < len; ++curr )
+            {
+                if ( ( data[ curr ] == ')' ) && ( data[ curr + delimLen + 1 ] == '"' ) && std::equal( data + open, data + paren, data + curr + 1 ) )
+                    return curr + delimLen + 2;
+            }
+            return len;
+        }
+    }
+
+    std::list< SIncludeDirective > CIncludeScanner::findIncludes( const QByteArray & contents )
+    {
+        std::list< SIncludeDirective > retVal;
+        auto data = contents.constData();
+        auto len = static_cast< size_t >( contents.size() );
+
+        bool atLineStart = true; // only white space and comments since the last newline
+        int deadDepth = 0; // inside "#if 0", the number of conditionals open since then
+        size_t pos = 0;
+        while ( pos < len )
+        {
+            auto ch = data[ pos ];
+            if ( ch == '\n' )
+            {
+                atLineStart = true;
+                ++pos;
+                continue;
+            }
+            if ( isSpace( ch ) )
+            {
+                ++pos;
+                continue;
+            }
+            if ( auto cont = continuationLength( data, len, pos ) )
+            {
+                pos += cont;
+                continue;
+            }
+            if ( ( ch == '/' ) && ( pos + 1 < len ) && ( data[ pos + 1 ] == '/' ) )
+            {
+                while ( ( pos < len ) && ( data[ pos ] != '\n' ) )
+                    pos += std::max< size_t >( 1, continuationLength( data, len, pos ) );
+                continue;
+            }
+            if ( ( ch == '/' ) && ( pos + 1 < len ) && ( data[ pos + 1 ] == '*' ) )
+            {
+                pos = skipBlockComment( data, len, pos );
+                continue;
+            }
+
+            if ( ( ch == '#' ) && atLineStart )
+            {
+                pos = skipHorizontalSpace( data, len, pos + 1 );
+                auto wordStart = pos;
+                while ( ( pos < len ) && isIdentifier( data[ pos ] ) )
+                    ++pos;
+                auto word = QByteArray::fromRawData( data + wordStart, static_cast< int >( pos - wordStart ) );
+
+                if ( ( word == "include" ) || ( word == "include_next" ) || ( word == "import" ) )
+                {
+                    pos = skipHorizontalSpace( data, len, pos );
+                    if ( !deadDepth && ( pos < len ) && ( ( data[ pos ] == '<' ) || ( data[ pos ] == '"' ) ) )
+                    {
+                        auto close = ( data[ pos ] == '<' ) ? '>' : '"';
+                        auto nameStart = ++pos;
+                        while ( ( pos < len ) && ( data[ pos ] != close ) && ( data[ pos ] != '\n' ) )
+                            ++pos;
+                        if ( ( pos < len ) && ( data[ pos ] == close ) && ( pos > nameStart ) )
+                            retVal.push_back( { QString::fromUtf8( data + nameStart, static_cast< int >( pos - nameStart ) ), close == '>' } );
+                    }
+                    // #include MACRO can not be followed without evaluating the macro, it is skipped
+                }
+                else if ( ( word == "if" ) || ( word == "ifdef" ) || ( word == "ifndef" ) )
+                {
+                    if ( deadDepth )
+                        deadDepth++;
+                    else if ( word == "if" )
+                    {
+                        pos = skipHorizontalSpace( data, len, pos );
+                        if ( ( pos < len ) && ( data[ pos ] == '0' ) )
+                        {
+                            auto after = skipHorizontalSpace( data, len, pos + 1 );
+                            if ( ( after >= len ) || ( data[ after ] == '\n' ) || ( data[ after ] == '/' ) )
+                                deadDepth = 1;
+                        }
+                    }
+                }
+                else if ( word == "endif" )
+                {
+                    if ( deadDepth )
+                        deadDepth--;
+                }
+                else if ( word.startsWith( "el" ) ) // else, elif, elifdef and elifndef, any of them may be taken
+                {
+                    if ( deadDepth == 1 )
+                        deadDepth = 0;
+                }
+                pos = skipToEndOfLine( data, len, pos );
+                continue;
+            }
+
+            atLineStart = false;
+            if ( deadDepth )
+                ++pos; // skipped groups need not hold valid tokens, a lone apostrophe is common there
+            else if ( ( ch == '\'' ) && ( pos > 0 ) && ( data[ pos - 1 ] >= '0' ) && ( data[ pos - 1 ] <= '9' ) )
+                ++pos; // a digit separator
+            else if ( ( ch == '"' ) || ( ch == '\'' ) )
+                pos = skipLiteral( data, len, pos );
+            else if ( ( ch == 'R' ) && ( pos + 1 < len ) && ( data[ pos + 1 ] == '"' ) && ( ( pos == 0 ) || !isIdentifier( data[ pos - 1 ] ) || ( data[ pos - 1 ] == 'u' ) || ( data[ pos - 1 ] == 'U' ) || ( data[ pos - 1 ] == 'L' ) || ( data[ pos - 1 ] == '8' ) ) )
+                pos = skipRawString( data, len, pos + 1 );
+            else
+                ++pos;
+        }
+        return retVal;
+    }
+}
@@ -0,0 +1,91 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __INCLUDESCANNER_H
+#define __INCLUDESCANNER_H
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class QByteArray;
+class QProgressDialog;
+
+namespace NVSProjectMaker
+{
+    class CSettings;
+    struct SSourceFileResults;
+
+    struct SIncludeDirective
+    {
+        QString fName;
+        bool fIsSystem{ false }; // <name> rather than "name"
+    };
+
+    // Files are numbered once, every edge is a pair of numbers and every path is stored once
+    struct SIncludeGraph
+    {
+        int numFiles() const { return static_cast< int >( fFiles.size() ); }
+        int findFile( const QString & relPath ) const; // -1 when the file is not part of the scan
+
+        QString getText( int numTop ) const;
+
+        std::vector< QString > fFiles; // relative to the source dir
+        std::unordered_map< QString, int > fFileIDs;
+        std::vector< std::vector< int > > fIncludes; // resolved, in the order of the #include lines
+        std::vector< QStringList > fUnresolved; // not found in the tree, mostly system and third party headers
+        std::vector< int > fFanIn; // files that include this one directly
+        std::vector< int > fClosureSize; // distinct files reachable through the includes, not counting the file itself
+        int fNumDirectives{ 0 };
+    };
+
+    // Builds the #include graph of the source and header files found by CSettings::loadSourceFiles.
+    // Includes resolve in memory against the scanned files, quoted ones first to the including
+    // file's dir and its incl/src peer, then to the include dirs, so no file system lookups are made.
+    class CIncludeScanner
+    {
+    public:
+        CIncludeScanner( const CSettings * settings );
+
+        std::shared_ptr< SIncludeGraph > scan( QProgressDialog * progress, int numThreads = 0 ) const; // 0 uses one thread per core, null when canceled
+
+        // Every #include, #include_next and #import outside of comments, strings and "#if 0" blocks.
+        // Other conditional blocks are not evaluated, the includes of all branches are returned.
+        static std::list< SIncludeDirective > findIncludes( const QByteArray & contents );
+        static QString pairedDir( const QString & dir ); // the incl dir for a src dir and the other way around
+    private:
+        int resolve( const SIncludeGraph & graph, const QString & fileDir, const SIncludeDirective & directive ) const;
+        static bool runParallel( size_t count, int numThreads, QProgressDialog * progress, const QString & label, const std::function< void( size_t ii, std::vector< int > & scratch ) > & func );
+
+        std::shared_ptr< SSourceFileResults > fResults;
+        QString fSourceDir;
+        QStringList fInclDirs; // relative to the source dir
+    };
+}
+
+#endif
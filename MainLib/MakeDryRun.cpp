@@ -0,0 +1,111 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MakeDryRun.h"
+
+#include <QObject>
+#include <QProcess>
+
+namespace NVSProjectMaker
+{
+    CMakeDryRunReader::CMakeDryRunReader( const SMakeDryRun & dryRun, const QString & dir ) :
+        fMakeCommand( dryRun.fMakeCommand.trimmed().isEmpty() ? QString( "make" ) : dryRun.fMakeCommand.trimmed() ),
+        fDir( dir )
+    {
+    }
+
+    CMakeDryRunReader::~CMakeDryRunReader()
+    {
+        close();
+    }
+
+    bool CMakeDryRunReader::open()
+    {
+        auto args = QProcess::splitCommand( fMakeCommand );
+        auto program = args.takeFirst();
+        args << dryRunArgs();
+
+        fProcess = std::make_unique< QProcess >();
+        fProcess->setWorkingDirectory( fDir );
+        fProcess->setStandardErrorFile( QProcess::nullDevice() );
+        fProcess->start( program, args, QIODevice::ReadOnly );
+        if ( !fProcess->waitForStarted() )
+        {
+            fStatus = std::make_pair( false, QObject::tr( "Could not run '%1' in '%2': %3" ).arg( fMakeCommand ).arg( fDir ).arg( fProcess->errorString() ) );
+            fProcess.reset();
+            return false;
+        }
+        fStatus = std::make_pair( true, QString() );
+        return true;
+    }
+
+    void CMakeDryRunReader::close()
+    {
+        if ( !fProcess )
+            return;
+
+        if ( fProcess->state() != QProcess::NotRunning )
+        {
+            fProcess->kill();
+            fProcess->waitForFinished();
+        }
+        fProcess.reset();
+    }
+
+    void CMakeDryRunReader::finish()
+    {
+        fFinished = true;
+        if ( fProcess->exitStatus() != QProcess::NormalExit )
+            fStatus = std::make_pair( false, QObject::tr( "'%1' crashed in '%2'" ).arg( fMakeCommand ).arg( fDir ) );
+        else
+            fExitCode = fProcess->exitCode();
+    }
+
+    bool CMakeDryRunReader::readLine( QString & line )
+    {
+        if ( !fProcess || fFinished )
+            return false;
+
+        while ( !fProcess->canReadLine() )
+        {
+            if ( fProcess->state() == QProcess::NotRunning )
+            {
+                auto remaining = fProcess->readAll();
+                finish();
+                if ( remaining.isEmpty() || !status() )
+                    return false;
+                fBytesRead += remaining.size();
+                line = QString::fromLocal8Bit( remaining );
+                return true;
+            }
+            fProcess->waitForReadyRead( 100 );
+        }
+
+        auto data = fProcess->readLine();
+        fBytesRead += data.size();
+        while ( data.endsWith( '\n' ) || data.endsWith( '\r' ) )
+            data.chop( 1 );
+        line = QString::fromLocal8Bit( data );
+        return true;
+    }
+}
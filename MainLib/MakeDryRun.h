@@ -0,0 +1,81 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __MAKEDRYRUN_H
+#define __MAKEDRYRUN_H
+
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <memory>
+
+class QProcess;
+
+namespace NVSProjectMaker
+{
+    // what to run to capture the build commands with make --dry-run instead of building
+    struct SMakeDryRun
+    {
+        QString fMakeCommand{ "make" }; // make or mtimake, may carry extra arguments
+        QStringList fDirs; // absolute build directories, make is run in each of them
+        int fMaxProcesses{ 0 }; // 0 runs QThread::idealThreadCount() directories at once
+    };
+
+    // Runs make -n -w -k in one directory and returns what it prints line by line, the same way
+    // CBuildOutputReader returns a build log.  It is used from a loader thread, so it relies on the
+    // blocking QProcess API rather than an event loop.  stderr is dropped, make -k still prints the
+    // commands of everything that does not depend on a failing target.
+    class CMakeDryRunReader
+    {
+    public:
+        CMakeDryRunReader( const SMakeDryRun & dryRun, const QString & dir );
+        ~CMakeDryRunReader();
+
+        bool open();
+        void close();
+
+        bool status() const { return fStatus.first; }
+        QString errorString() const { return fStatus.second; }
+        int exitCode() const { return fExitCode; }
+
+        qint64 size() const { return 0; } // unknown until make is done
+        qint64 pos() const { return fBytesRead; } // safe to call from any thread
+
+        bool readLine( QString & line );
+
+        static QStringList dryRunArgs() { return QStringList() << "-n" << "-w" << "-k"; }
+    private:
+        void finish();
+
+        QString fMakeCommand;
+        QString fDir;
+        std::unique_ptr< QProcess > fProcess;
+        std::atomic< qint64 > fBytesRead{ 0 };
+        int fExitCode{ 0 };
+        bool fFinished{ false };
+
+        std::pair< bool, QString > fStatus = std::make_pair( false, QString() );
+    };
+}
+
+#endif
@@ -0,0 +1,258 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PchRecommender.h"
+#include "BuildInfoData.h"
+#include "DirInfo.h"
+#include "FileClassifier.h"
+#include "IncludeScanner.h"
+#include "SourceBuildJoin.h"
+
+#include <QDir>
+#include <QObject>
+#include <algorithm>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    QStringList SPchRecommendation::headers() const
+    {
+        QStringList retVal;
+        for ( auto && ii : fHeaders )
+            retVal << ii.fHeader;
+        return retVal;
+    }
+
+    QString SPchRecommendation::getText() const
+    {
+        QStringList retVal;
+        auto percent = fTotalParses ? ( 100.0 * fEstimatedSaving / fTotalParses ) : 0.0;
+        retVal << QObject::tr( "%1: TUs: %2 Header Parses: %3 Saved: %4 (%5%) From: %6" )
+            .arg( fProject ).arg( fNumTUs ).arg( fTotalParses ).arg( fEstimatedSaving ).arg( percent, 0, 'f', 1 )
+            .arg( fFromBuildLog ? QObject::tr( "Build Log" ) : QObject::tr( "Source Scan" ) );
+        for ( auto && ii : fHeaders )
+            retVal << QObject::tr( "    %1 TUs: %2 Includes: %3" ).arg( ii.fHeader ).arg( ii.fNumTUs ).arg( ii.fClosureSize );
+        return retVal.join( "\n" );
+    }
+
+    CPchRecommender::CPchRecommender( const std::shared_ptr< const SIncludeGraph > & graph, const std::shared_ptr< const CSourceBuildJoin > & join, const QString & sourceDir ) :
+        fGraph( graph ),
+        fJoin( join ),
+        fSourceDir( sourceDir )
+    {
+    }
+
+    // the headers inside the tree are named relative to the source dir, the same as the scan names them
+    QString CPchRecommender::headerName( const QString & path ) const
+    {
+        if ( !fJoin )
+            return QDir::cleanPath( QDir::fromNativeSeparators( path ) );
+
+        auto retVal = fJoin->normalizePath( path );
+        auto root = fJoin->normalizePath( fSourceDir ) + "/";
+        if ( retVal.startsWith( root ) )
+            retVal = retVal.mid( root.length() );
+        return retVal;
+    }
+
+    // each note is nested in the notes before it with a smaller depth, so a stack of the open
+    // headers gives both the closure sizes and the nesting in one pass
+    bool CPchRecommender::fromBuildLog( const QString & relPath, STUIncludes & includes ) const
+    {
+        if ( !fJoin )
+            return false;
+
+        auto file = fJoin->findFile( relPath );
+        if ( !file )
+            return false;
+
+        std::shared_ptr< SCompileItem > compileItem;
+        for ( auto && ii : fJoin->itemsForFile( file ) )
+        {
+            auto curr = std::dynamic_pointer_cast< SCompileItem >( ii );
+            if ( curr && !curr->fShowIncludes.empty() )
+            {
+                compileItem = curr;
+                break;
+            }
+        }
+        if ( !compileItem )
+            return false;
+
+        auto && notes = compileItem->fShowIncludes;
+        std::vector< QString > names;
+        names.reserve( notes.size() );
+        for ( auto && ii : notes )
+            names.push_back( headerName( ii.second ) );
+
+        auto finish = [&includes, &names]( size_t index, size_t end )
+        {
+            auto && closure = includes.fClosureSizes[ names[ index ] ];
+            closure = std::max( closure, static_cast< int >( end - index - 1 ) );
+        };
+
+        std::vector< size_t > open;
+        for ( size_t ii = 0; ii < notes.size(); ++ii )
+        {
+            while ( !open.empty() && ( notes[ open.back() ].first >= notes[ ii ].first ) )
+            {
+                finish( open.back(), ii );
+                open.pop_back();
+            }
+            auto && includedBy = includes.fIncludedBy[ names[ ii ] ];
+            for ( auto && jj : open )
+                includedBy.insert( names[ jj ] );
+            open.push_back( ii );
+        }
+        for ( auto && ii : open )
+            finish( ii, notes.size() );
+        return true;
+    }
+
+    bool CPchRecommender::fromGraph( const QString & relPath, STUIncludes & includes, std::vector< int > & seen, int stamp ) const
+    {
+        if ( !fGraph )
+            return false;
+
+        auto id = fGraph->findFile( relPath );
+        if ( id == -1 )
+            return false;
+
+        std::vector< int > stack = { id };
+        seen[ id ] = stamp;
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            for ( auto && ii : fGraph->fIncludes[ curr ] )
+            {
+                if ( seen[ ii ] == stamp )
+                    continue;
+                seen[ ii ] = stamp;
+                stack.push_back( ii );
+                includes.fClosureSizes[ fGraph->fFiles[ ii ] ] = fGraph->fClosureSize[ ii ];
+            }
+        }
+        return true;
+    }
+
+    bool CPchRecommender::graphReaches( const QString & from, const QString & to ) const
+    {
+        if ( !fGraph )
+            return false;
+
+        auto fromID = fGraph->findFile( from );
+        auto toID = fGraph->findFile( to );
+        if ( ( fromID == -1 ) || ( toID == -1 ) )
+            return false;
+
+        std::vector< bool > seen( fGraph->numFiles(), false );
+        std::vector< int > stack = { fromID };
+        seen[ fromID ] = true;
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            for ( auto && ii : fGraph->fIncludes[ curr ] )
+            {
+                if ( ii == toID )
+                    return true;
+                if ( seen[ ii ] )
+                    continue;
+                seen[ ii ] = true;
+                stack.push_back( ii );
+            }
+        }
+        return false;
+    }
+
+    // System headers without a suffix only show up in the build log, the scan never resolves them.
+    // Only headers most of the project's TUs read are candidates, a pch forces itself on every TU.
+    // The best scoring are taken first, skipping the ones a taken header already brings in.
+    std::shared_ptr< SPchRecommendation > CPchRecommender::recommend( const SDirInfo & dirInfo, int maxHeaders ) const
+    {
+        auto retVal = std::make_shared< SPchRecommendation >();
+        retVal->fProject = dirInfo.fProjectName.isEmpty() ? dirInfo.fRelToDir : dirInfo.fProjectName;
+
+        std::unordered_map< QString, SPchCandidate > candidates;
+        std::unordered_map< QString, std::unordered_set< QString > > includedBy;
+        std::vector< int > seen( fGraph ? fGraph->numFiles() : 0, 0 );
+        int stamp = 0;
+        for ( auto && ii : dirInfo.fSourceFiles )
+        {
+            STUIncludes includes;
+            if ( fromBuildLog( ii, includes ) )
+                retVal->fFromBuildLog = true;
+            else if ( !fromGraph( ii, includes, seen, ++stamp ) )
+                continue;
+
+            retVal->fNumTUs++;
+            for ( auto && jj : includes.fClosureSizes )
+            {
+                retVal->fTotalParses++;
+                if ( CFileClassifier::isSourceFile( jj.first ) ) // included sources are unity builds, not pch material
+                    continue;
+                auto && candidate = candidates[ jj.first ];
+                candidate.fHeader = jj.first;
+                candidate.fNumTUs++;
+                candidate.fClosureSize = std::max( candidate.fClosureSize, jj.second );
+            }
+            for ( auto && jj : includes.fIncludedBy )
+                includedBy[ jj.first ].insert( jj.second.begin(), jj.second.end() );
+        }
+
+        auto minTUs = std::max( 2, ( retVal->fNumTUs + 1 ) / 2 );
+        std::vector< SPchCandidate > ranked;
+        for ( auto && ii : candidates )
+        {
+            if ( ii.second.fNumTUs >= minTUs )
+                ranked.push_back( ii.second );
+        }
+        std::sort( ranked.begin(), ranked.end(), []( const SPchCandidate & lhs, const SPchCandidate & rhs )
+        {
+            if ( lhs.score() != rhs.score() )
+                return lhs.score() > rhs.score();
+            return lhs.fHeader < rhs.fHeader;
+        } );
+
+        auto isCovered = [this, &retVal, &includedBy]( const QString & header )
+        {
+            auto pos = includedBy.find( header );
+            for ( auto && ii : retVal->fHeaders )
+            {
+                if ( ( pos != includedBy.end() ) ? ( ( *pos ).second.count( ii.fHeader ) != 0 ) : graphReaches( ii.fHeader, header ) )
+                    return true;
+            }
+            return false;
+        };
+        for ( auto && ii : ranked )
+        {
+            if ( static_cast< int >( retVal->fHeaders.size() ) >= maxHeaders )
+                break;
+            if ( isCovered( ii.fHeader ) )
+                continue;
+            retVal->fHeaders.push_back( ii );
+            retVal->fEstimatedSaving += static_cast< qint64 >( ii.fNumTUs - 1 ) * ( ii.fClosureSize + 1 );
+        }
+        return retVal;
+    }
+}
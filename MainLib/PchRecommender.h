@@ -0,0 +1,90 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __PCHRECOMMENDER_H
+#define __PCHRECOMMENDER_H
+
+#include <QString>
+#include <QStringList>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    class CSourceBuildJoin;
+    struct SDirInfo;
+    struct SIncludeGraph;
+
+    struct SPchCandidate
+    {
+        QString fHeader; // relative to the source dir when it is part of the tree, otherwise as reported
+        int fNumTUs{ 0 }; // translation units of the project that include it, directly or not
+        int fClosureSize{ 0 }; // files it brings in, not counting itself
+
+        qint64 score() const { return static_cast< qint64 >( fNumTUs ) * ( fClosureSize + 1 ); }
+    };
+
+    struct SPchRecommendation
+    {
+        QString fProject;
+        int fNumTUs{ 0 };
+        bool fFromBuildLog{ false }; // the /showIncludes notes rather than the source scan
+        std::list< SPchCandidate > fHeaders; // best first
+        qint64 fTotalParses{ 0 }; // header parses over all the translation units without a pch
+        qint64 fEstimatedSaving{ 0 }; // header parses a pch of fHeaders avoids
+
+        bool isEmpty() const { return fHeaders.empty(); }
+        QStringList headers() const;
+        QString getText() const;
+    };
+
+    // Ranks the headers of a generated project by the number of its translation units that
+    // include them times the size of what they include.  The include sets come from the
+    // /showIncludes notes of the build log when the sources were compiled with it, otherwise
+    // from the #include graph of the source scan.
+    class CPchRecommender
+    {
+    public:
+        CPchRecommender( const std::shared_ptr< const SIncludeGraph > & graph, const std::shared_ptr< const CSourceBuildJoin > & join, const QString & sourceDir );
+
+        std::shared_ptr< SPchRecommendation > recommend( const SDirInfo & dirInfo, int maxHeaders = 8 ) const;
+    private:
+        struct STUIncludes
+        {
+            std::unordered_map< QString, int > fClosureSizes; // every header the TU reads
+            std::unordered_map< QString, std::unordered_set< QString > > fIncludedBy; // the headers each one is nested in, only from the build log
+        };
+        bool fromBuildLog( const QString & relPath, STUIncludes & includes ) const;
+        bool fromGraph( const QString & relPath, STUIncludes & includes, std::vector< int > & seen, int stamp ) const;
+        bool graphReaches( const QString & from, const QString & to ) const;
+        QString headerName( const QString & path ) const;
+
+        std::shared_ptr< const SIncludeGraph > fGraph;
+        std::shared_ptr< const CSourceBuildJoin > fJoin;
+        QString fSourceDir;
+    };
+}
+
+#endif
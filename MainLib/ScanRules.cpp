@@ -0,0 +1,252 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "ScanRules.h"
+
+#include <QFile>
+#include <QObject>
+
+#include <algorithm>
+
+namespace NVSProjectMaker
+{
+    // git ignores case where the file system does
+    static QString foldCase( const QString & str )
+    {
+#ifdef Q_OS_WIN
+        return str.toCaseFolded();
+#else
+        return str;
+#endif
+    }
+
+    static bool isLiteral( const QString & pattern )
+    {
+        for ( auto && ch : pattern )
+        {
+            if ( ( ch == '*' ) || ( ch == '?' ) || ( ch == '[' ) || ( ch == '\\' ) )
+                return false;
+        }
+        return true;
+    }
+
+    // * and ? stay within one directory, a ** component matches any number of directories
+    static QString globToRegExp( const QString & glob )
+    {
+        QString retVal;
+        for ( int ii = 0; ii < glob.length(); ++ii )
+        {
+            auto ch = glob[ ii ];
+            if ( ( ch == '*' ) && ( ( ii + 1 ) < glob.length() ) && ( glob[ ii + 1 ] == '*' ) )
+            {
+                auto atStart = ( ii == 0 ) || ( glob[ ii - 1 ] == '/' );
+                if ( atStart && ( ( ii + 2 ) < glob.length() ) && ( glob[ ii + 2 ] == '/' ) )
+                {
+                    retVal += "(?:.*/)?";
+                    ii += 2;
+                }
+                else
+                {
+                    retVal += ( atStart && ( ( ii + 2 ) == glob.length() ) ) ? ".*" : "[^/]*";
+                    ii += 1;
+                }
+            }
+            else if ( ch == '*' )
+                retVal += "[^/]*";
+            else if ( ch == '?' )
+                retVal += "[^/]";
+            else if ( ch == '[' )
+            {
+                auto end = glob.indexOf( ']', ii + 2 ); // a ] first in the set is part of it
+                if ( end == -1 )
+                {
+                    retVal += "\\[";
+                    continue;
+                }
+                auto set = glob.mid( ii + 1, end - ii - 1 );
+                if ( set.startsWith( '!' ) )
+                    set[ 0 ] = '^';
+                retVal += "[" + set.replace( "\\", "\\\\" ) + "]";
+                ii = end;
+            }
+            else if ( ( ch == '\\' ) && ( ( ii + 1 ) < glob.length() ) )
+                retVal += QRegularExpression::escape( glob.mid( ++ii, 1 ) );
+            else
+                retVal += QRegularExpression::escape( QString( ch ) );
+        }
+        return QRegularExpression::anchoredPattern( retVal );
+    }
+
+    CScanRules::CScanRules( const QStringList & lines, const QString & baseDir, const QString & source, const std::shared_ptr< const CScanRules > & parent ) :
+        fBaseDir( foldCase( baseDir ) ),
+        fSource( source ),
+        fParent( parent )
+    {
+        for ( auto && ii : lines )
+            addRule( ii );
+    }
+
+    void CScanRules::addRule( const QString & line )
+    {
+        auto pattern = line;
+        if ( pattern.endsWith( '\r' ) )
+            pattern.chop( 1 );
+        while ( pattern.endsWith( ' ' ) && !pattern.endsWith( "\\ " ) )
+            pattern.chop( 1 );
+        if ( pattern.isEmpty() || pattern.startsWith( '#' ) )
+            return;
+
+        bool negated = pattern.startsWith( '!' );
+        if ( negated || pattern.startsWith( "\\!" ) || pattern.startsWith( "\\#" ) )
+            pattern.remove( 0, 1 );
+        bool dirOnly = pattern.endsWith( '/' );
+        if ( dirOnly )
+            pattern.chop( 1 );
+        if ( pattern.startsWith( "**/" ) && !pattern.mid( 3 ).contains( '/' ) )
+            pattern.remove( 0, 3 ); // the same as a pattern without a /
+        bool onPath = pattern.contains( '/' ); // a / anywhere but the end anchors the pattern to the base dir
+        if ( pattern.startsWith( '/' ) )
+            pattern.remove( 0, 1 );
+        pattern = foldCase( pattern );
+        if ( pattern.isEmpty() )
+            return;
+
+        auto index = static_cast< int >( fRules.size() );
+        if ( !onPath && isLiteral( pattern ) )
+            fNames[ pattern ].push_back( index );
+        else if ( !onPath && ( pattern.length() > 1 ) && pattern.startsWith( '*' ) && isLiteral( pattern.mid( 1 ) ) )
+        {
+            auto && rules = fSuffixes[ pattern.mid( 1 ) ];
+            if ( rules.empty() && ( std::find( fSuffixLengths.begin(), fSuffixLengths.end(), pattern.length() - 1 ) == fSuffixLengths.end() ) )
+                fSuffixLengths.push_back( pattern.length() - 1 );
+            rules.push_back( index );
+        }
+        else if ( onPath && isLiteral( pattern ) )
+            fPaths[ pattern ].push_back( index );
+        else
+        {
+            QRegularExpression regEx( globToRegExp( pattern ) );
+            if ( !regEx.isValid() )
+                return;
+            regEx.optimize();
+            fGlobs.push_back( { index, onPath, regEx } );
+        }
+
+        auto && rule = fRules.emplace_back();
+        rule.fText = line.trimmed();
+        rule.fSource = fSource;
+        rule.fNegated = negated;
+        rule.fDirOnly = dirOnly;
+    }
+
+    std::shared_ptr< const CScanRules > CScanRules::loadGitIgnore( const QString & dir, const QString & relDir, const std::shared_ptr< const CScanRules > & parent )
+    {
+        QFile file( dir + "/.gitignore" );
+        if ( !file.open( QIODevice::ReadOnly ) )
+            return parent;
+
+        auto retVal = std::make_shared< CScanRules >( QString::fromUtf8( file.readAll() ).split( '\n' ), relDir, relDir.isEmpty() ? QString( ".gitignore" ) : ( relDir + "/.gitignore" ), parent );
+        if ( retVal->isEmpty() )
+            return parent;
+        return retVal;
+    }
+
+    std::shared_ptr< const CScanRules > CScanRules::loadGitIgnores( const QDir & sourceDir, const QString & relDir )
+    {
+        auto retVal = loadGitIgnore( sourceDir.absolutePath(), QString(), {} );
+        if ( relDir.isEmpty() )
+            return retVal;
+
+        QString currDir;
+        for ( auto && ii : relDir.split( '/' ) )
+        {
+            currDir = currDir.isEmpty() ? ii : ( currDir + "/" + ii );
+            retVal = loadGitIgnore( sourceDir.absoluteFilePath( currDir ), currDir, retVal );
+        }
+        return retVal;
+    }
+
+    int CScanRules::lastMatch( const TRuleMap & map, const QString & key, bool isDir, int best ) const
+    {
+        auto pos = map.find( key );
+        if ( pos == map.end() )
+            return best;
+        for ( auto ii = ( *pos ).second.rbegin(); ( ii != ( *pos ).second.rend() ) && ( *ii > best ); ++ii )
+        {
+            if ( isDir || !fRules[ *ii ].fDirOnly )
+                return *ii;
+        }
+        return best;
+    }
+
+    // the keys looked up are views of the path, fromRawData does not copy
+    const SScanRule * CScanRules::match( const QString & relPath, bool isDir ) const
+    {
+        if ( fRules.empty() )
+            return nullptr;
+
+        auto path = foldCase( relPath );
+        auto below = path;
+        if ( !fBaseDir.isEmpty() )
+        {
+            if ( ( path.length() <= fBaseDir.length() ) || ( path[ fBaseDir.length() ] != '/' ) || !path.startsWith( fBaseDir ) )
+                return nullptr;
+            below = QString::fromRawData( path.constData() + fBaseDir.length() + 1, path.length() - fBaseDir.length() - 1 );
+        }
+        auto namePos = below.lastIndexOf( '/' ) + 1;
+        auto name = QString::fromRawData( below.constData() + namePos, below.length() - namePos );
+
+        int best = -1;
+        best = lastMatch( fNames, name, isDir, best );
+        for ( auto && ii : fSuffixLengths )
+        {
+            if ( ii <= name.length() )
+                best = lastMatch( fSuffixes, QString::fromRawData( name.constData() + name.length() - ii, ii ), isDir, best );
+        }
+        best = lastMatch( fPaths, below, isDir, best );
+        for ( auto ii = fGlobs.rbegin(); ( ii != fGlobs.rend() ) && ( ( *ii ).fRule > best ); ++ii )
+        {
+            if ( !isDir && fRules[ ( *ii ).fRule ].fDirOnly )
+                continue;
+            if ( ( *ii ).fRegEx.match( ( *ii ).fOnPath ? below : name ).hasMatch() )
+            {
+                best = ( *ii ).fRule;
+                break;
+            }
+        }
+        return ( best == -1 ) ? nullptr : &fRules[ best ];
+    }
+
+    QStringList CScanRules::getSkippedText() const
+    {
+        QStringList retVal;
+        for ( auto && ii : fRules )
+        {
+            if ( ii.fNumSkipped == 0 )
+                continue;
+            auto rule = ii.fSource.isEmpty() ? ii.fText : QString( "%1: %2" ).arg( ii.fSource ).arg( ii.fText );
+            retVal << QObject::tr( "Scan Rule '%1' skipped %2 files and directories" ).arg( rule ).arg( ii.fNumSkipped.load() );
+        }
+        return retVal;
+    }
+}
@@ -0,0 +1,91 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __SCANRULES_H
+#define __SCANRULES_H
+
+#include <QDir>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    struct SScanRule
+    {
+        QString fText; // the line as written
+        QString fSource; // the .gitignore it came from, relative to the source dir, empty for the project's rules
+        bool fNegated{ false }; // a ! rule, what it matches is scanned even when an earlier rule skips it
+        bool fDirOnly{ false }; // a trailing /, it only matches directories
+        mutable std::atomic< int > fNumSkipped{ 0 };
+    };
+
+    // One list of gitignore style rules, the project's or one .gitignore file's, compiled once when
+    // the scan starts.  Rules that are a plain name, a *suffix or a plain path are hash lookups, the
+    // rest are glob patterns compiled to regular expressions, so a path costs a few lookups no
+    // matter how many rules there are.  As in git, the last rule that matches decides, and the
+    // rules of a .gitignore take precedence over those of the directories above it.
+    class CScanRules
+    {
+    public:
+        CScanRules( const QStringList & lines, const QString & baseDir = QString(), const QString & source = QString(), const std::shared_ptr< const CScanRules > & parent = {} );
+
+        // the rules of dir's .gitignore on top of parent, or parent itself when dir has none
+        static std::shared_ptr< const CScanRules > loadGitIgnore( const QString & dir, const QString & relDir, const std::shared_ptr< const CScanRules > & parent );
+        // the rules of the .gitignore files in relDir and every directory above it, null when there are none
+        static std::shared_ptr< const CScanRules > loadGitIgnores( const QDir & sourceDir, const QString & relDir );
+
+        bool isEmpty() const { return fRules.empty(); }
+        const std::shared_ptr< const CScanRules > & parent() const { return fParent; } // the rules of the directories above
+        const SScanRule * match( const QString & relPath, bool isDir ) const; // the last of these rules matching the path, null when none does
+        QStringList getSkippedText() const; // one line for each rule that skipped something
+    private:
+        struct SGlob
+        {
+            int fRule;
+            bool fOnPath; // matched against the path below the base dir rather than the name
+            QRegularExpression fRegEx;
+        };
+        using TRuleMap = std::unordered_map< QString, std::vector< int > >; // to the rules with the key, in order
+
+        void addRule( const QString & line );
+        int lastMatch( const TRuleMap & map, const QString & key, bool isDir, int best ) const;
+
+        QString fBaseDir; // relative to the source dir, the rules only match below it
+        QString fSource;
+        std::shared_ptr< const CScanRules > fParent;
+        std::deque< SScanRule > fRules;
+        TRuleMap fNames; // plain names, matched at any depth
+        TRuleMap fSuffixes; // *suffix, matched at any depth
+        std::vector< int > fSuffixLengths; // every length in fSuffixes
+        TRuleMap fPaths; // plain paths relative to the base dir
+        std::vector< SGlob > fGlobs; // in rule order
+    };
+}
+
+#endif
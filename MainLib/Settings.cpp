@@ -24,6 +24,10 @@
 #include "DebugTarget.h"
 #include "VSProjectMaker.h"
 #include "DirInfo.h"
+#include "FlatSourceTree.h"
+#include "PchRecommender.h"
+#include "ScanRules.h"
+#include "SourceTreeWalker.h"
 #include "Version.h"
 #include "SABUtils/JsonUtils.h"
 #include "SABUtils/VSInstallUtils.h"
@@ -33,6 +37,7 @@
 #include <QStandardItem>
 #include <QString>
 #include <QStringList>
+#include <algorithm>
 #include <list>
 #include <set>
 #include <QSettings>
@@ -49,6 +54,10 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonValue>
+#include <QEventLoop>
+#include <QTimer>
+#include <chrono>
+#include <future>
 
 namespace NVSProjectMaker
 {
@@ -171,47 +180,38 @@ namespace NVSProjectMaker
         return true;
     }
 
-    void CSettings::incProgress( QProgressDialog * progress ) const
+    SScanSettings::SScanSettings( const TStringSet & buildDirs, const QStringList & inclDirs, const TExecNameType & execNames, const std::unordered_set< QString > & generatedFiles, const QStringList & scanRules, bool honorGitIgnore ) :
+        fBuildDirs( buildDirs.begin(), buildDirs.end() ),
+        fInclDirs( inclDirs.begin(), inclDirs.end() ),
+        fExecNames( execNames ),
+        fGeneratedFiles( generatedFiles ),
+        fScanRules( std::make_shared< CScanRules >( scanRules ) ),
+        fHonorGitIgnore( honorGitIgnore )
     {
-        if ( !progress )
-            return;
-
-        progress->setValue( progress->value() + 1 );
-        //if ( progress->value() >= 100 )
-        //    progress->setValue( 1 );
-        qApp->processEvents();
     }
 
-    bool CSettings::isBuildDir( const QDir & relToDir, const QDir & dir ) const
+    bool SScanSettings::isIgnored( const QString & relPath, bool isDir, const CScanRules * gitIgnore ) const
     {
-        //qDebug() << dir.dirName();
-        bool retVal = QFileInfo(relToDir.absoluteFilePath(dir.filePath("subdir.mk"))).exists();
-        retVal = retVal || QFileInfo(relToDir.absoluteFilePath(dir.filePath("Makefile"))).exists();
-        retVal = retVal || QFileInfo(relToDir.absoluteFilePath(dir.filePath("makefile.inc"))).exists();
-        auto bldDirs = getBuildDirs();
-        retVal = retVal || ( bldDirs.find( dir.path() ) != bldDirs.end() );
-        return retVal;
+        auto rule = fScanRules->match( relPath, isDir );
+        for ( auto curr = gitIgnore; !rule && curr; curr = curr->parent().get() )
+            rule = curr->match( relPath, isDir );
+        if ( !rule || rule->fNegated )
+            return false;
+        rule->fNumSkipped++;
+        return true;
     }
 
-    bool CSettings::isInclDir( const QDir & relToDir, const QDir & dir ) const
+    const std::list< std::pair< QString, bool > > * SScanSettings::getExecutables( const QString & relPath ) const
     {
-        bool retVal = dir.dirName() == "incl";
-        retVal = retVal || getInclDirs().contains( dir.path() );
-        if ( !retVal )
-        {
-            QDirIterator di( relToDir.absoluteFilePath( dir.path() ), { "*.h", "*.hh", "*.hpp" }, QDir::Files );
-            retVal = di.hasNext();
-        }
-        return retVal;
+        auto pos = fExecNames.find( relPath );
+        if ( pos == fExecNames.end() )
+            return nullptr;
+        return &( *pos ).second;
     }
 
-    std::list< std::pair< QString, bool > > CSettings::getExecutables( const QDir & dir ) const
+    std::shared_ptr< const SScanSettings > CSettings::getScanSettings() const
     {
-        auto execNames = getExecNames();
-        auto pos = execNames.find( dir.path() );
-        if ( pos != execNames.end() )
-            return (*pos).second;
-        return {};
+        return std::make_shared< SScanSettings >( getBuildDirs(), getInclDirs(), getExecNames(), fGeneratedFiles, getScanRules(), getHonorGitIgnore() );
     }
 
     QStringList CSettings::addInclDirs( const QStringList & inclDirs )
@@ -616,7 +616,8 @@ namespace NVSProjectMaker
 
         logit( QObject::tr( "============================================" ) );
         logit( QObject::tr( "Computing totals" ) );
-        int totalChildren = fResults->computeTotal( progress );
+        CFlatSourceTree tree( fResults->fRootDir );
+        int totalChildren = tree.computeTotal();
 
         qApp->processEvents();
         logit( QObject::tr( "============================================" ) );
@@ -629,13 +630,13 @@ namespace NVSProjectMaker
             progress->adjustSize();
         }
 
-        if ( !getParentOfPairDirectoriesMap( nullptr, progress ) )
+        if ( !getParentOfPairDirectoriesMap( tree, progress ) )
         {
             QApplication::restoreOverrideCursor();
             return {};
         }
 
-        auto dirs = getDirInfo( nullptr, progress );
+        auto dirs = getDirInfo( tree, progress );
         if ( progress && progress->wasCanceled() )
         {
             QApplication::restoreOverrideCursor();
@@ -660,32 +661,85 @@ namespace NVSProjectMaker
         return dirs;
     }
 
-    bool CSettings::getParentOfPairDirectoriesMap( std::shared_ptr< SSourceFileInfo > parent, QProgressDialog * progress ) const
+    // The src and incl dirs among one directory's children.  The scanned tree holds every child
+    // name, so pairing is decided without looking at the file system.
+    struct SPairPeers
     {
-        auto && childList = parent ? parent->fChildren : fResults->fRootDir->fChildren;
-        QDir sourceDir( getSourceDir().value() );
+        void addChildDir( const QStringRef & name )
+        {
+            fHasSrc = fHasSrc || isName( name, "src" );
+            fHasIncl = fHasIncl || isName( name, "incl" );
+        }
 
-        for ( auto && curr : childList )
+        bool isParentToPairedDirs() const { return fHasSrc && fHasIncl; }
+        bool isPairedInclSrcDir( const QStringRef & childName ) const // the child ends with incl or src, and its peer exists
         {
-            if ( progress )
-                progress->setValue( progress->value() + 1 );
-            qApp->processEvents();
-            if ( progress && progress->wasCanceled() )
+            if ( childName.endsWith( QLatin1String( "incl" ) ) )
+                return fHasSrc;
+            if ( childName.endsWith( QLatin1String( "src" ) ) )
+                return fHasIncl;
+            return false;
+        }
+
+        // the peer used to be found with a file system lookup, which ignores case on windows
+        static bool isName( const QStringRef & name, const char * peer )
+        {
+#ifdef Q_OS_WIN
+            return name.compare( QLatin1String( peer ), Qt::CaseInsensitive ) == 0;
+#else
+            return name == QLatin1String( peer );
+#endif
+        }
+
+        bool fHasSrc{ false };
+        bool fHasIncl{ false };
+    };
+
+    // the passes over the flat tree only repaint every so many nodes
+    static bool updateGenerateProgress( QProgressDialog * progress, int value )
+    {
+        if ( !progress || ( ( value % 256 ) != 0 ) )
+            return true;
+        progress->setValue( value );
+        qApp->processEvents();
+        return !progress->wasCanceled();
+    }
+
+    bool CSettings::getParentOfPairDirectoriesMap( CFlatSourceTree & tree, QProgressDialog * progress ) const
+    {
+        // a directory's children are classified when it is reached, a parent comes before its
+        // children so a paired dir is flagged before it is checked for being a parent itself
+        for ( int ii = 0; ii < tree.size(); ++ii )
+        {
+            if ( !updateGenerateProgress( progress, ii ) )
                 return false;
 
-            if ( !curr->fIsDir )
+            if ( !tree.isDir( ii ) )
                 continue;
 
-            if ( !getParentOfPairDirectoriesMap( curr, progress ) )
-                 return false;
+            auto curr = tree.sourceInfo( ii );
+            curr->fPairedChildDirectores.clear();
 
-            if ( !curr->isPairedInclSrcDir( getSourceDir().value() ) )
+            SPairPeers peers;
+            for ( auto child = tree.node( ii ).fFirstChild; child != -1; child = tree.node( child ).fNextSibling )
+            {
+                if ( tree.isDir( child ) )
+                    peers.addChildDir( tree.name( child ) );
+            }
+            if ( !peers.fHasSrc && !peers.fHasIncl )
                 continue;
 
-            if ( parent )
-                parent->fPairedChildDirectores.push_back( curr );
-            else
-                fResults->fRootDir->fPairedChildDirectores.push_back( curr );
+            // the source dir itself is never a project
+            if ( ( ii != 0 ) && !tree.hasFlag( ii, SFlatSourceNode::eIsPairedInclSrcDir ) && peers.isParentToPairedDirs() )
+                tree.setFlag( ii, SFlatSourceNode::eIsParentToPairedDirs );
+
+            for ( auto child = tree.node( ii ).fFirstChild; child != -1; child = tree.node( child ).fNextSibling )
+            {
+                if ( !tree.isDir( child ) || !peers.isPairedInclSrcDir( tree.name( child ) ) )
+                    continue;
+                tree.setFlag( child, SFlatSourceNode::eIsPairedInclSrcDir );
+                curr->fPairedChildDirectores.push_back( tree.sourceInfo( child ) );
+            }
         }
         if ( progress && progress->wasCanceled() )
             return false;
@@ -697,40 +751,38 @@ namespace NVSProjectMaker
         return ( projectName == getPrimaryTarget() ) ? "ALL" : QString();
     }
 
-    std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > CSettings::getDirInfo( std::shared_ptr< SSourceFileInfo > parent, QProgressDialog * progress ) const
+    std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > CSettings::getDirInfo( const CFlatSourceTree & tree, QProgressDialog * progress ) const
     {
         std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > retVal;
 
-        if ( parent && !parent->fIsDir )
-            return {};
-
-        auto && childList = parent ? parent->fChildren : fResults->fRootDir->fChildren;
         QDir sourceDir( getSourceDir().value() );
-
-        auto currNum = 0;
-        for( auto && curr : childList )
+        auto totalChildren = tree.computeTotal();
+        for ( int ii = 1; ii < tree.size(); )
         {
-            if ( progress )
+            if ( !updateGenerateProgress( progress, totalChildren + ii ) )
+                return {};
+
+            if ( !tree.isDir( ii ) )
             {
-                progress->setValue( progress->value() + 1 );
-                qApp->processEvents();
-                if ( progress->wasCanceled() )
-                    return {};
+                ++ii;
+                continue;
             }
 
-            if ( !curr->fIsDir )
+            // its files belong to its parent's project, and nothing below it is a project
+            if ( tree.hasFlag( ii, SFlatSourceNode::eIsPairedInclSrcDir ) )
             {
+                ii = tree.subtreeEnd( ii );
                 continue;
             }
 
-            if ( curr->isPairedInclSrcDir( getSourceDir().value() ) )
-                 continue;
-
-            auto currInfo = std::make_shared< NVSProjectMaker::SDirInfo >( curr );
+            auto currInfo = std::make_shared< NVSProjectMaker::SDirInfo >( tree, ii );
+            currInfo->removeFiles( [ this ]( const QString & path ) { return isGeneratedFile( path ); } );
+            if ( fPchRecommender && !currInfo->fSourceFiles.isEmpty() )
+                currInfo->fPchRecommendation = fPchRecommender->recommend( *currInfo );
             currInfo->fExtraTargets = getCustomBuildsForSourceDir( QFileInfo( sourceDir.absoluteFilePath( currInfo->fRelToDir ) ).canonicalFilePath() );
             currInfo->fDebugCommands = getDebugCommandsForSourceDir( QFileInfo( sourceDir.absoluteFilePath( currInfo->fRelToDir ) ).canonicalFilePath() );
 
-            if ( curr->isParentToPairedDirs( getSourceDir().value() ) )
+            if ( tree.hasFlag( ii, SFlatSourceNode::eIsParentToPairedDirs ) )
             {
                 currInfo->fExtraTargets  << getCustomBuildsForSourceDir( QFileInfo( sourceDir.absoluteFilePath( currInfo->fRelToDir + "/src" ) ).canonicalFilePath() );
                 currInfo->fExtraTargets  << getCustomBuildsForSourceDir( QFileInfo( sourceDir.absoluteFilePath( currInfo->fRelToDir + "/incl" ) ).canonicalFilePath() );
@@ -745,8 +797,7 @@ namespace NVSProjectMaker
             {
                 retVal.push_back( currInfo );
             }
-            auto children = getDirInfo( curr, progress );
-            retVal.insert( retVal.end(), children.begin(), children.end() );
+            ++ii;
         }
         if ( progress && progress->wasCanceled() )
             return {};
@@ -754,6 +805,30 @@ namespace NVSProjectMaker
         return retVal;
     }
 
+    void CSettings::setGeneratedFiles( const QStringList & files )
+    {
+        fGeneratedFiles.clear();
+        auto sourceDirPath = getSourceDir();
+        if ( !sourceDirPath.has_value() )
+            return;
+
+        QDir sourceDir( sourceDirPath.value() );
+        for ( auto ii : files )
+        {
+            ii = QDir::fromNativeSeparators( ii );
+            if ( ii.startsWith( "<PRODDIR>/" ) )
+                ii = ii.mid( 10 );
+            else if ( !QDir::isRelativePath( ii ) )
+                ii = sourceDir.relativeFilePath( ii );
+            fGeneratedFiles.insert( QDir::cleanPath( ii ) );
+        }
+    }
+
+    bool CSettings::isGeneratedFile( const QString & relPath ) const
+    {
+        return !fGeneratedFiles.empty() && ( fGeneratedFiles.find( QDir::cleanPath( relPath ) ) != fGeneratedFiles.end() );
+    }
+
     QString CSettings::getClientName() const
     {
         if ( getClientDir().isEmpty() )
@@ -877,73 +952,65 @@ namespace NVSProjectMaker
         return retVal;
     }
 
-    bool CSettings::loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, std::shared_ptr< SSourceFileInfo  > parent, const std::function< void( const QString & msg ) > & logit )
+    bool CSettings::loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, const std::function< void( const QString & msg ) > & logit, int numThreads )
     {
         QDir baseDir( dir );
         if ( !baseDir.exists() || !sourceDir.exists() )
             return false;
 
-        auto relDirPath = sourceDir.relativeFilePath( dir );
-        if ( getVerbose() )
-            logit( relDirPath );
-        if ( progress )
+        std::shared_ptr< CSourceScanCache > cache;
+        if ( !fSettingsFileName.isEmpty() )
         {
-            progress->setLabelText( QObject::tr( "Finding Source Files...\nIn directory '%1'" ).arg( relDirPath ) );
-            progress->adjustSize();
-            progress->setRange( 0, baseDir.count() );
-            incProgress( progress );
+            cache = std::make_shared< CSourceScanCache >( fSettingsFileName + ".scancache", sourceDir.absolutePath() );
+            cache->load();
         }
 
-        QDirIterator iter( dir, QStringList(), QDir::Filter::AllDirs | QDir::Filter::Files | QDir::Filter::NoDotAndDotDot | QDir::Filter::Readable, QDirIterator::IteratorFlag::NoIteratorFlags );
-        while ( iter.hasNext() )
+        CSourceTreeWalker walker( getScanSettings(), sourceDir );
+        walker.setCache( cache );
+        bool completed = false;
+        if ( progress )
         {
-            incProgress( progress );
-            if ( progress && progress->wasCanceled() )
-                return true;
-
-            auto curr = QFileInfo( iter.next() );
-            relDirPath = sourceDir.relativeFilePath( curr.absoluteFilePath() );
-            auto node = std::make_shared< SSourceFileInfo >();
-            node->fIsDir = curr.isDir();
-            node->fRelToDir = relDirPath;
-            parent->fChildren.push_back( node );
-            
-            if ( !curr.isDir() )
-            {
-                fResults->fFiles++;
-            }
-            else
-            {
-                fResults->fDirs++;
-                // determine if its a build dir, has an exec name (or names), or include path
-                node->fIsBuildDir = CSettings::isBuildDir( sourceDir, relDirPath );
-                node->fIsIncludeDir = CSettings::isInclDir( sourceDir, relDirPath );
-                node->fExecutables = CSettings::getExecutables( relDirPath );
-
-                QStringList execNames;
-                for ( auto && ii : node->fExecutables )
-                    execNames << ii.first;
-                QStringList guiExecs;
-                for ( auto && ii : node->fExecutables )
-                    guiExecs << ( ii.second ? "Yes" : "No" );
-
-                if ( node->fIsBuildDir )
-                    fResults->fBuildDirs.push_back( relDirPath );
-                if ( node->fIsIncludeDir )
-                    fResults->fInclDirs.push_back( relDirPath );
-                fResults->fExecutables.insert( fResults->fExecutables.end(), node->fExecutables.begin(), node->fExecutables.end() );
-
-                if ( loadSourceFiles( sourceDir, curr.absoluteFilePath(), progress, node, logit ) )
-                    return true;
-            }
+            // the walk runs on its own thread, the GUI thread only samples its progress and repaints
+            auto cancelToken = std::make_shared< CScanCancelToken >();
+            walker.setCancelToken( cancelToken );
+            auto scan = std::async( std::launch::async, [ & ]() { return walker.walk( dir, fResults->fRootDir, numThreads ); } );
+
+            progress->setRange( 0, 0 );
+            progress->setValue( 0 );
+            progress->setLabelText( QObject::tr( "Finding Source Files..." ) );
+            progress->adjustSize();
 
+            QEventLoop loop;
+            QTimer timer;
+            QObject::connect( &timer, &QTimer::timeout, [ & ]()
+                {
+                    if ( progress->wasCanceled() )
+                        cancelToken->cancel();
+                    if ( scan.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready )
+                        loop.quit();
+                    else
+                        progress->setLabelText( QObject::tr( "Finding Source Files...\n%1\n%2 directories, %3 files" ).arg( walker.currentDir() ).arg( walker.numDirs() ).arg( walker.numFiles() ) );
+                } );
+            timer.start( 100 );
+            loop.exec();
+            completed = scan.get();
         }
-        return progress ? progress->wasCanceled() : false;
-    }
+        else
+            completed = walker.walk( dir, fResults->fRootDir, numThreads );
+        if ( !completed )
+            return true;
+        if ( cache && !cache->save() && logit )
+            logit( QObject::tr( "WARNING: Could not write the source scan cache '%1'" ).arg( fSettingsFileName + ".scancache" ) );
 
-    bool CSettings::loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, const std::function< void( const QString & msg ) > & logit )
-    {
-        return loadSourceFiles( sourceDir, dir, progress, fResults->fRootDir, logit );
+        CSourceTreeWalker::collectResults( fResults->fRootDir, *fResults, getVerbose() ? logit : std::function< void( const QString & msg ) >() );
+        if ( getVerbose() && logit )
+            logit( QObject::tr( "Directories Listed: %1 Reused From The Scan Cache: %2" ).arg( walker.numListed() ).arg( walker.numReused() ) );
+        if ( logit )
+        {
+            for ( auto && ii : walker.getSkippedText() )
+                logit( ii );
+        }
+        return false;
     }
 
     std::optional< QString > CSettings::getDir( const QString & relDir, bool relPath ) const
@@ -1017,6 +1084,13 @@ namespace NVSProjectMaker
         ADD_SETTING_VALUE( DebugCommands );
         ADD_SETTING_VALUE( BuildOutputDataFile );
         ADD_SETTING_VALUE( BldTxtProdDir );
+        ADD_SETTING_VALUE( DecodeOptionsOnDemand );
+        ADD_SETTING_VALUE( CollectLoadStats );
+        ADD_SETTING_VALUE( RecommendPchHeaders );
+        ADD_SETTING_VALUE( WatchSourceTree );
+        ADD_SETTING_VALUE( ScanRules );
+        ADD_SETTING_VALUE( HonorGitIgnore );
+        ADD_SETTING_VALUE( DryRunMakeCommand );
         ADD_SETTING_VALUE( Verbose );
     }
 
@@ -1078,6 +1152,13 @@ namespace NVSProjectMaker
         qDebug() << "DebugCommands=" << getDebugCommands();
         qDebug() << "BuildOutputDataFile=" << getBuildOutputDataFile();
         qDebug() << "BldTxtProdDir=" << getBldTxtProdDir();
+        qDebug() << "DecodeOptionsOnDemand=" << getDecodeOptionsOnDemand();
+        qDebug() << "CollectLoadStats=" << getCollectLoadStats();
+        qDebug() << "RecommendPchHeaders=" << getRecommendPchHeaders();
+        qDebug() << "WatchSourceTree=" << getWatchSourceTree();
+        qDebug() << "ScanRules=" << getScanRules();
+        qDebug() << "HonorGitIgnore=" << getHonorGitIgnore();
+        qDebug() << "DryRunMakeCommand=" << getDryRunMakeCommand();
 
         qDebug() << "Verbose=" << getVerbose();
     }
@@ -1300,44 +1381,75 @@ namespace NVSProjectMaker
         return retVal;
     }
 
-    int SSourceFileResults::computeTotal( QProgressDialog * progress )
+    QString SSourceFileInfo::relPath() const
     {
-        int retVal = 0;
-        if ( progress )
-        {
-            progress->setLabelText( QObject::tr( "Computing total number of children" ) );
-            progress->setRange( 0, static_cast<int>( fRootDir->fChildren.size() ) );
-            progress->setValue( 0 );
-            qApp->processEvents();
-        }
-        for ( auto && curr : fRootDir->fChildren )
+        QString retVal;
+        getRelPath( retVal );
+        return retVal;
+    }
+
+    // the names are copied in from the end, so the path is built in one allocation at most
+    void SSourceFileInfo::getRelPath( QString & buffer ) const
+    {
+        int length = -1;
+        for ( auto curr = this; curr->fParent; curr = curr->fParent )
+            length += curr->fName.length() + 1;
+        buffer.resize( std::max( length, 0 ) );
+        if ( length <= 0 )
+            return;
+
+        auto out = buffer.data() + length;
+        for ( auto curr = this; curr->fParent; curr = curr->fParent )
         {
-            if ( progress )
-                progress->setValue( progress->value() + 1 );
-            retVal += computeTotal( curr );
+            out -= curr->fName.length();
+            std::copy( curr->fName.constBegin(), curr->fName.constEnd(), out );
+            if ( curr->fParent->fParent )
+                *--out = '/';
         }
-        return retVal;
     }
 
-    int SSourceFileResults::computeTotal( std::shared_ptr< SSourceFileInfo > parent )
+    const QString & CRelPathCache::relPath( const SSourceFileInfo * node )
     {
-        if ( !parent )
-            return 0;
+        if ( node->fIsDir || !node->fParent )
+            return dirPath( node );
+
+        auto && parentPath = dirPath( node->fParent );
+        fBuffer.resize( 0 );
+        if ( !parentPath.isEmpty() )
+            fBuffer.append( parentPath ).append( '/' );
+        fBuffer.append( node->fName );
+        return fBuffer;
+    }
 
-        int retVal = static_cast<int>( parent->fChildren.size() );
-        for ( auto && ii : parent->fChildren )
+    const QString & CRelPathCache::dirPath( const SSourceFileInfo * dir )
+    {
+        auto pos = fDirPaths.find( dir );
+        if ( pos != fDirPaths.end() )
+            return ( *pos ).second;
+
+        QString path;
+        if ( dir->fParent )
         {
-            retVal += computeTotal( ii );
+            path = dirPath( dir->fParent );
+            if ( !path.isEmpty() )
+                path += '/';
+            path += dir->fName;
         }
-        return retVal;
+        return fDirPaths[ dir ] = path; // a rehash keeps the other paths where they are
     }
 
     void SSourceFileInfo::createItem( QStandardItem * parent ) const
     {
-        auto node = new QStandardItem( fRelToDir );
+        parent->appendRow( createRow() );
+    }
+
+    QList< QStandardItem * > SSourceFileInfo::createRow() const
+    {
+        auto relToDir = relPath();
+        auto node = new QStandardItem( relToDir );
         QList<QStandardItem *> row;
         node->setData( fIsDir, NVSProjectMaker::ERoles::eIsDirRole );
-        node->setData( fRelToDir, NVSProjectMaker::ERoles::eRelPathRole );
+        node->setData( relToDir, NVSProjectMaker::ERoles::eRelPathRole );
         row << node;
 
         if ( fIsDir )
@@ -1361,32 +1473,21 @@ namespace NVSProjectMaker
             for( auto ii : fChildren )
                 ii->createItem( node );
         }
-
-        parent->appendRow( row );
+        return row;
     }
 
-    bool SSourceFileInfo::isPairedInclSrcDir( const QString & srcDir ) const // return true when name is incl or src, and the peer directory exists
+    bool SSourceFileInfo::isPairedInclSrcDir() const // return true when name is incl or src, and its parent has the peer directory
     {
-        if ( !fRelToDir.endsWith( "incl" ) && !fRelToDir.endsWith( "src" ) )
+        if ( !fIsDir || !fParent )
             return false;
 
-        QDir dir( srcDir );
-        dir.cd( fRelToDir );
-        dir.cdUp();
-
-        bool otherExists = false;
-        if ( fRelToDir.endsWith( "incl" ) )
-            otherExists = QFileInfo( dir.absoluteFilePath( "src" ) ).exists();
-        else if ( fRelToDir.endsWith( "src" ) )
-            otherExists = QFileInfo( dir.absoluteFilePath( "incl" ) ).exists();
-        return otherExists;
-    }
-
-    bool SSourceFileInfo::isParentToPairedDirs( const QString & srcDir ) const // return true when name is incl or src, and the peer directory exists
-    {
-        QDir dir( srcDir );
-        dir.cd( fRelToDir );
-        return QFileInfo( dir.absoluteFilePath( "src" ) ).exists() && QFileInfo( dir.absoluteFilePath( "incl" ) ).exists();
+        SPairPeers peers;
+        for ( auto && ii : fParent->fChildren )
+        {
+            if ( ii->fIsDir )
+                peers.addChildDir( QStringRef( &ii->fName ) );
+        }
+        return peers.isPairedInclSrcDir( QStringRef( &fName ) );
     }
 }
 
@@ -31,6 +31,8 @@
 #include <QVariant>
 #include <QDebug>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include <QDir>
 #include <functional>
 #include <optional>
@@ -138,6 +140,9 @@ namespace NVSProjectMaker
 {
     struct SDebugTarget;
     struct SDirInfo;
+    class CPchRecommender;
+    class CFlatSourceTree;
+    class CScanRules;
 }
 
 using TExecNameType = std::unordered_map< QString, std::list< std::pair< QString, bool > > >;
@@ -153,10 +158,12 @@ QDebug& operator<<( QDebug& stream, const TExecNameType& value );
 
 namespace NVSProjectMaker
 {
+    // Only the name is kept in each node, deep trees would otherwise repeat the same long
+    // prefixes in every path.  The relative path is rebuilt from the names up to the source dir.
     struct SSourceFileInfo
     {
-        QString fName;
-        QString fRelToDir;
+        QString fName; // the source dir's is only shown in the GUI, it is not part of any path
+        SSourceFileInfo * fParent{ nullptr }; // the directory whose fChildren holds this node, null for the source dir
 
         bool fIsBuildDir{ false };
         bool fIsDir{ false };
@@ -167,10 +174,26 @@ namespace NVSProjectMaker
 
         std::list< std::shared_ptr< SSourceFileInfo > > fPairedChildDirectores;
 
+        QString relPath() const; // relative to the source dir, empty for the source dir
+        void getRelPath( QString & buffer ) const; // the same, reusing the buffer's allocation
+
         void createItem( QStandardItem * parent ) const;
+        QList< QStandardItem * > createRow() const; // the row createItem appends, with the children below it
 
-        bool isPairedInclSrcDir( const QString & srcDir ) const; // return true when name is incl or src, and the peer directory exists
-        bool isParentToPairedDirs( const QString & srcDir ) const; // returns true when the dir has both an incl and src child dir
+        bool isPairedInclSrcDir() const; // return true when name is incl or src, and its parent has the peer directory
+    };
+
+    // Rebuilds the relative paths of many nodes, keeping the path of every directory it builds, so
+    // a file's path costs one copy of its parent's path.  Only valid while the tree is unchanged.
+    class CRelPathCache
+    {
+    public:
+        const QString & relPath( const SSourceFileInfo * node ); // valid until the next call
+    private:
+        const QString & dirPath( const SSourceFileInfo * dir );
+
+        std::unordered_map< const SSourceFileInfo *, QString > fDirPaths;
+        QString fBuffer;
     };
 
     struct SSourceFileResults
@@ -198,12 +221,34 @@ namespace NVSProjectMaker
             fQtLibs.clear();
             fRootDir = std::make_shared< SSourceFileInfo >();
         }
-        int computeTotal( std::shared_ptr< SSourceFileInfo > parent );
-
-        int computeTotal( QProgressDialog * progress );
         std::shared_ptr< SSourceFileInfo > fRootDir;
     };
 
+    // The settings the source scan reads for every directory and file, copied into hashes once when
+    // the scan starts.  It is never changed afterwards, so the scan threads share it without locking.
+    struct SScanSettings
+    {
+        SScanSettings( const TStringSet & buildDirs, const QStringList & inclDirs, const TExecNameType & execNames, const std::unordered_set< QString > & generatedFiles, const QStringList & scanRules, bool honorGitIgnore );
+
+        bool isBuildDir( const QString & relPath ) const { return fBuildDirs.find( relPath ) != fBuildDirs.end(); }
+        bool isInclDir( const QString & relPath ) const { return fInclDirs.find( relPath ) != fInclDirs.end(); }
+        bool isGeneratedFile( const QString & relPath ) const { return !fGeneratedFiles.empty() && ( fGeneratedFiles.find( relPath ) != fGeneratedFiles.end() ); } // relPath must be clean
+        const std::list< std::pair< QString, bool > > * getExecutables( const QString & relPath ) const; // null when none are set
+
+        // the project's rules take precedence over the .gitignore files, counts the rule that skips the path
+        bool isIgnored( const QString & relPath, bool isDir, const CScanRules * gitIgnore ) const;
+        bool honorGitIgnore() const { return fHonorGitIgnore; }
+        const std::shared_ptr< const CScanRules > & scanRules() const { return fScanRules; }
+
+    private:
+        std::unordered_set< QString > fBuildDirs;
+        std::unordered_set< QString > fInclDirs;
+        TExecNameType fExecNames;
+        std::unordered_set< QString > fGeneratedFiles;
+        std::shared_ptr< const CScanRules > fScanRules;
+        bool fHonorGitIgnore{ false };
+    };
+
     class CSettings
     {
     public:
@@ -215,7 +260,7 @@ namespace NVSProjectMaker
         void reset();
 
         QString fileName() const;
-        bool loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, const std::function< void( const QString & msg ) > & logit );
+        bool loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, const std::function< void( const QString & msg ) > & logit, int numThreads = 0 ); // returns true when canceled, 0 threads uses one per core
         std::optional< QString > getModelTechDir( bool relPath = false ) const;
         std::optional< QString > getBuildDir( bool relPath = false ) const;
         std::optional< QString > getSourceDir( bool relPath = false ) const;
@@ -228,16 +273,14 @@ namespace NVSProjectMaker
         bool loadSettings( const QString & fileName ); // sets the filename and loads from it
         bool setFileName( const QString & fileName, bool andSave );
 
-        bool isBuildDir( const QDir & relToDir, const QDir & dir ) const;
-        bool isInclDir( const QDir & relToDir, const QDir & dir ) const;
-        std::list< std::pair< QString, bool > > getExecutables( const QDir & dir ) const;
+        std::shared_ptr< const SScanSettings > getScanSettings() const; // a snapshot for one scan
 
         QStringList addInclDirs( const QStringList & inclDirs );
         QStringList addPreProcessorDefines( const QStringList & preProcDefines );
         bool generate( QProgressDialog * progress, QWidget * parent, const std::function< void( const QString & msg ) > & logit ) const;
         std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > generateTopLevelFiles( QProgressDialog * progress, const std::function< void( const QString & msg ) > & logit, QWidget * parent ) const;
-        std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > getDirInfo( std::shared_ptr< SSourceFileInfo > parent, QProgressDialog * progress ) const;
-        bool getParentOfPairDirectoriesMap( std::shared_ptr< SSourceFileInfo > parent, QProgressDialog * progress ) const;
+        std::list< std::shared_ptr< NVSProjectMaker::SDirInfo > > getDirInfo( const CFlatSourceTree & tree, QProgressDialog * progress ) const; // run getParentOfPairDirectoriesMap on the tree first
+        bool getParentOfPairDirectoriesMap( CFlatSourceTree & tree, QProgressDialog * progress ) const;
 
         std::pair< QString, bool > findSampleOutputPath(const QString & baseName ) const;
         
@@ -247,6 +290,13 @@ namespace NVSProjectMaker
         [[nodiscard]] QString getEnvVarsForShell() const;
 
         [[nodiscard]] std::shared_ptr< NVSProjectMaker::SSourceFileResults > getResults() const { return fResults; }
+
+        // the moc, uic and rcc outputs of the loaded build data, they are left out of the scan and the generated projects
+        void setGeneratedFiles( const QStringList & files );
+        [[nodiscard]] bool isGeneratedFile( const QString & relPath ) const;
+
+        // when set, getDirInfo attaches a precompiled header recommendation to each project with sources
+        void setPchRecommender( const std::shared_ptr< const NVSProjectMaker::CPchRecommender > & recommender ) { fPchRecommender = recommender; }
         [[nodiscard]] QString getClientName() const;
 
         [[nodiscard]] static QString getCMakeExecViaVSPath( const QString & dir );
@@ -292,6 +342,13 @@ namespace NVSProjectMaker
         ADD_SETTING( TListOfDebugTargets, DebugCommands );
         ADD_SETTING( QString, BuildOutputDataFile );
         ADD_SETTING( QString, BldTxtProdDir );
+        ADD_SETTING( bool, DecodeOptionsOnDemand );
+        ADD_SETTING( bool, CollectLoadStats );
+        ADD_SETTING( bool, RecommendPchHeaders );
+        ADD_SETTING( bool, WatchSourceTree );
+        ADD_SETTING( QStringList, ScanRules );
+        ADD_SETTING( bool, HonorGitIgnore );
+        ADD_SETTING( QString, DryRunMakeCommand );
 
         ADD_SETTING( bool, Verbose );
 
@@ -306,9 +363,7 @@ namespace NVSProjectMaker
         void registerSetting( const QString & attribName, CValueBase * value ) const;
         QStringList getCustomBuildsForSourceDir( const QString & inSourcePath ) const;
         std::list < NVSProjectMaker::SDebugTarget > getDebugCommandsForSourceDir( const QString & inSourcePath ) const;
-        bool loadSourceFiles( const QDir & sourceDir, const QString & dir, QProgressDialog * progress, std::shared_ptr< SSourceFileInfo  > parent, const std::function< void( const QString & msg ) > & logit );
         bool loadData();
-        void incProgress( QProgressDialog * progress ) const;
         void registerSettings();
         void loadQtSettings();
 
@@ -333,6 +388,8 @@ namespace NVSProjectMaker
         QString fSettingsFileName;
         void dump() const;
         std::shared_ptr< NVSProjectMaker::SSourceFileResults > fResults;
+        std::unordered_set< QString > fGeneratedFiles; // relative to the source dir
+        std::shared_ptr< const NVSProjectMaker::CPchRecommender > fPchRecommender;
         mutable std::map< QString, std::pair< QString, bool > > fSamplesMap;
         mutable std::unordered_map< QString, CValueBase* > fSettings;
         mutable NSABUtils::NVSInstallUtils::TInstalledVisualStudios fInstalledVSes;
@@ -0,0 +1,193 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "SourceBuildJoin.h"
+#include "BuildInfoData.h"
+#include "FileClassifier.h"
+#include "Settings.h"
+
+#include <QObject>
+#include <unordered_set>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    CSourceBuildJoin::CSourceBuildJoin( const QDir & sourceDir, const std::shared_ptr< SSourceFileResults > & results, const CBuildInfoData & buildData ) :
+        fSourceRoot( QDir::cleanPath( sourceDir.absolutePath() ) )
+    {
+#ifdef Q_OS_WIN
+        fCaseSensitivity = Qt::CaseInsensitive;
+#endif
+        if ( !results || !results->fRootDir )
+            return;
+
+        fFilesByPath.reserve( static_cast< size_t >( results->fFiles ) );
+        addTreeFiles( results->fRootDir );
+        joinItems( buildData );
+        findUncompiled( results->fRootDir );
+    }
+
+    QString CSourceBuildJoin::normalizePath( QString path ) const
+    {
+        path = QDir::fromNativeSeparators( path );
+        if ( path.startsWith( "<PRODDIR>" ) )
+            path = fSourceRoot + "/" + path.mid( 9 );
+        else if ( QDir::isRelativePath( path ) )
+            path = fSourceRoot + "/" + path;
+        path = QDir::cleanPath( path );
+        if ( fCaseSensitivity == Qt::CaseInsensitive )
+            path = path.toLower();
+        return path;
+    }
+
+    // the tree can be deep, walk it with an explicit stack rather than recursion
+    void CSourceBuildJoin::addTreeFiles( const std::shared_ptr< SSourceFileInfo > & root )
+    {
+        CRelPathCache paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { root };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( ii->fIsDir )
+                    stack.push_back( ii );
+                else
+                    fFilesByPath[ normalizePath( paths.relPath( ii.get() ) ) ] = ii;
+            }
+        }
+    }
+
+    void CSourceBuildJoin::joinItems( const CBuildInfoData & buildData )
+    {
+        std::unordered_set< QString > missing;
+        for ( auto && item : buildData.items() )
+        {
+            auto compileItem = std::dynamic_pointer_cast< SCompileItem >( item );
+            if ( !compileItem )
+                continue;
+
+            for ( auto && ii : compileItem->fSourceFiles )
+            {
+                auto path = normalizePath( ii );
+                auto pos = fFilesByPath.find( path );
+                if ( pos == fFilesByPath.end() )
+                {
+                    if ( missing.insert( path ).second )
+                        fMissingFromTree << path;
+                    continue;
+                }
+                auto && items = fItemsForFile[ ( *pos ).second.get() ];
+                if ( items.empty() )
+                    fNumCompiledSources++;
+                items.push_back( item );
+                fFilesForItem[ item.get() ].push_back( ( *pos ).second );
+            }
+        }
+    }
+
+    void CSourceBuildJoin::findUncompiled( const std::shared_ptr< SSourceFileInfo > & root )
+    {
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { root };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            if ( curr->fIsBuildDir && !hasCompiledSource( curr ) )
+                fEmptyProjectDirs.push_back( curr );
+
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( ii->fIsDir )
+                    stack.push_back( ii );
+                else if ( CFileClassifier::isSourceFile( ii->fName ) && ( fItemsForFile.find( ii.get() ) == fItemsForFile.end() ) )
+                    fUncompiledSources.push_back( ii );
+            }
+        }
+    }
+
+    // a project is generated from the dir's own files plus those of its paired incl/src dirs, see SDirInfo::getFiles
+    bool CSourceBuildJoin::hasCompiledSource( const std::shared_ptr< SSourceFileInfo > & dir ) const
+    {
+        auto dirs = std::list< std::shared_ptr< SSourceFileInfo > >( { dir } );
+        dirs.insert( dirs.end(), dir->fPairedChildDirectores.begin(), dir->fPairedChildDirectores.end() );
+        for ( auto && curr : dirs )
+        {
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( !ii->fIsDir && ( fItemsForFile.find( ii.get() ) != fItemsForFile.end() ) )
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    std::list< std::shared_ptr< SItem > > CSourceBuildJoin::itemsForFile( const std::shared_ptr< SSourceFileInfo > & file ) const
+    {
+        auto pos = fItemsForFile.find( file.get() );
+        if ( pos == fItemsForFile.end() )
+            return {};
+        return ( *pos ).second;
+    }
+
+    std::list< std::shared_ptr< SSourceFileInfo > > CSourceBuildJoin::filesForItem( const std::shared_ptr< SItem > & item ) const
+    {
+        auto pos = fFilesForItem.find( item.get() );
+        if ( pos == fFilesForItem.end() )
+            return {};
+        return ( *pos ).second;
+    }
+
+    std::shared_ptr< SSourceFileInfo > CSourceBuildJoin::findFile( const QString & path ) const
+    {
+        auto pos = fFilesByPath.find( normalizePath( path ) );
+        if ( pos == fFilesByPath.end() )
+            return {};
+        return ( *pos ).second;
+    }
+
+    QString CSourceBuildJoin::getText( bool verbose ) const
+    {
+        QStringList retVal;
+        retVal << QObject::tr( "Source/Build Join: Files: %1 Compiled: %2 Never Compiled: %3 Compiled but not in the Source Tree: %4 Empty Projects: %5" )
+            .arg( static_cast< int >( fFilesByPath.size() ) )
+            .arg( fNumCompiledSources )
+            .arg( static_cast< int >( fUncompiledSources.size() ) )
+            .arg( fMissingFromTree.count() )
+            .arg( static_cast< int >( fEmptyProjectDirs.size() ) );
+        if ( !verbose )
+            return retVal.join( "\n" );
+
+        retVal << QObject::tr( "Never Compiled:" );
+        for ( auto && ii : fUncompiledSources )
+            retVal << "    " + ii->relPath();
+        retVal << QObject::tr( "Compiled but not in the Source Tree:" );
+        for ( auto && ii : fMissingFromTree )
+            retVal << "    " + ii;
+        retVal << QObject::tr( "Empty Projects:" );
+        for ( auto && ii : fEmptyProjectDirs )
+            retVal << "    " + ii->relPath();
+        return retVal.join( "\n" );
+    }
+}
@@ -0,0 +1,81 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef __SOURCEBUILDJOIN_H
+#define __SOURCEBUILDJOIN_H
+
+#include <QString>
+#include <QStringList>
+#include <QDir>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+namespace NVSProjectMaker
+{
+    class CBuildInfoData;
+    struct SItem;
+    struct SSourceFileInfo;
+    struct SSourceFileResults;
+
+    // Correlates the scanned source tree with the compile items of the build log.  Both sides are
+    // reduced to one normalized absolute path (<PRODDIR> and relative paths resolved against the
+    // source dir, clean separators, lower case where the file system ignores case) and joined
+    // through a hash of the tree's files, so the join is linear in files + compiled sources.
+    class CSourceBuildJoin
+    {
+    public:
+        CSourceBuildJoin( const QDir & sourceDir, const std::shared_ptr< SSourceFileResults > & results, const CBuildInfoData & buildData );
+
+        QString normalizePath( QString path ) const;
+
+        std::list< std::shared_ptr< SItem > > itemsForFile( const std::shared_ptr< SSourceFileInfo > & file ) const;
+        std::list< std::shared_ptr< SSourceFileInfo > > filesForItem( const std::shared_ptr< SItem > & item ) const;
+        std::shared_ptr< SSourceFileInfo > findFile( const QString & path ) const;
+
+        const std::list< std::shared_ptr< SSourceFileInfo > > & uncompiledSources() const { return fUncompiledSources; } // source files no compile item builds
+        const QStringList & missingFromTree() const { return fMissingFromTree; } // compiled files the scan did not find
+        const std::list< std::shared_ptr< SSourceFileInfo > > & emptyProjectDirs() const { return fEmptyProjectDirs; } // build dirs without a single compiled source
+
+        QString getText( bool verbose ) const;
+    private:
+        void addTreeFiles( const std::shared_ptr< SSourceFileInfo > & root );
+        void joinItems( const CBuildInfoData & buildData );
+        void findUncompiled( const std::shared_ptr< SSourceFileInfo > & root );
+        bool hasCompiledSource( const std::shared_ptr< SSourceFileInfo > & dir ) const;
+
+        QString fSourceRoot;
+        Qt::CaseSensitivity fCaseSensitivity{ Qt::CaseSensitive };
+
+        std::unordered_map< QString, std::shared_ptr< SSourceFileInfo > > fFilesByPath;
+        std::unordered_map< const SSourceFileInfo *, std::list< std::shared_ptr< SItem > > > fItemsForFile;
+        std::unordered_map< const SItem *, std::list< std::shared_ptr< SSourceFileInfo > > > fFilesForItem;
+
+        std::list< std::shared_ptr< SSourceFileInfo > > fUncompiledSources;
+        QStringList fMissingFromTree;
+        std::list< std::shared_ptr< SSourceFileInfo > > fEmptyProjectDirs;
+        int fNumCompiledSources{ 0 };
+    };
+}
+
+#endif
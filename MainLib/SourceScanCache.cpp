@@ -0,0 +1,169 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SourceScanCache.h"
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include <chrono>
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace NVSProjectMaker
+{
+    static const quint32 kMagic = 0x4e565343; // NVSC
+    static const quint32 kVersion = 1;
+    static const qint64 kRacyNSecs = 2000000000LL; // FAT keeps modification times to 2 seconds
+
+    CSourceScanCache::CSourceScanCache( const QString & fileName, const QString & sourceDir ) :
+        fFileName( fileName ),
+        fSourceDir( QDir::cleanPath( sourceDir ) )
+    {
+    }
+
+    bool CSourceScanCache::load()
+    {
+        fDirs.clear();
+        QFile file( fFileName );
+        if ( !file.open( QIODevice::ReadOnly ) )
+            return false;
+
+        QDataStream ds( &file );
+        ds.setVersion( QDataStream::Qt_5_15 );
+        quint32 magic = 0;
+        quint32 version = 0;
+        QString sourceDir;
+        quint32 numDirs = 0;
+        ds >> magic >> version >> sourceDir >> fScannedAt >> numDirs;
+        if ( ( ds.status() != QDataStream::Ok ) || ( magic != kMagic ) || ( version != kVersion ) || ( sourceDir != fSourceDir ) )
+            return false;
+
+        fDirs.reserve( numDirs );
+        for ( quint32 ii = 0; ii < numDirs; ++ii )
+        {
+            QString relPath;
+            SScanCachedDir dir;
+            quint32 numEntries = 0;
+            ds >> relPath >> dir.fKey.fMTime >> dir.fKey.fDevice >> dir.fKey.fInode >> numEntries;
+            if ( ds.status() != QDataStream::Ok )
+                break;
+            if ( numEntries > ( file.size() - file.pos() ) / 5 ) // every entry takes at least a string length and a bool
+            {
+                ds.setStatus( QDataStream::ReadCorruptData );
+                break;
+            }
+            dir.fEntries.resize( numEntries );
+            for ( auto && jj : dir.fEntries )
+                ds >> jj.fName >> jj.fIsDir;
+            fDirs[ relPath ] = std::move( dir );
+        }
+        if ( ds.status() != QDataStream::Ok )
+        {
+            fDirs.clear();
+            return false;
+        }
+        return true;
+    }
+
+    // written to a temporary file first, a scan canceled or crashing while saving leaves the old cache
+    bool CSourceScanCache::save() const
+    {
+        QSaveFile file( fFileName );
+        if ( !file.open( QIODevice::WriteOnly ) )
+            return false;
+
+        QDataStream ds( &file );
+        ds.setVersion( QDataStream::Qt_5_15 );
+        ds << kMagic << kVersion << fSourceDir << fScannedAt << static_cast< quint32 >( fDirs.size() );
+        for ( auto && ii : fDirs )
+        {
+            ds << ii.first << ii.second.fKey.fMTime << ii.second.fKey.fDevice << ii.second.fKey.fInode << static_cast< quint32 >( ii.second.fEntries.size() );
+            for ( auto && jj : ii.second.fEntries )
+                ds << jj.fName << jj.fIsDir;
+        }
+        if ( ds.status() != QDataStream::Ok )
+        {
+            file.cancelWriting();
+            return false;
+        }
+        return file.commit();
+    }
+
+    const std::vector< SScanDirEntry > * CSourceScanCache::findEntries( const QString & relPath, const SScanDirKey & key ) const
+    {
+        auto pos = fDirs.find( relPath );
+        if ( pos == fDirs.end() )
+            return nullptr;
+        if ( ( ( *pos ).second.fKey != key ) || ( key.fMTime >= fScannedAt - kRacyNSecs ) )
+            return nullptr;
+        return &( *pos ).second.fEntries;
+    }
+
+    void CSourceScanCache::setDirs( std::unordered_map< QString, SScanCachedDir > && dirs, qint64 scannedAt )
+    {
+        fDirs = std::move( dirs );
+        fScannedAt = scannedAt;
+    }
+
+    qint64 CSourceScanCache::now()
+    {
+        return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+    }
+
+    bool CSourceScanCache::statDirectory( const QString & path, SScanDirKey & key )
+    {
+#ifdef Q_OS_WIN
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if ( !GetFileAttributesExW( reinterpret_cast< LPCWSTR >( QDir::toNativeSeparators( path ).utf16() ), GetFileExInfoStandard, &data ) )
+            return false;
+
+        // FILETIMEs count 100ns from 1601, the Unix epoch is 11644473600 seconds later
+        auto toNSecs = []( const FILETIME & time )
+        {
+            auto ticks = ( static_cast< qint64 >( time.dwHighDateTime ) << 32 ) | time.dwLowDateTime;
+            return ( ticks - 116444736000000000LL ) * 100;
+        };
+        key.fMTime = toNSecs( data.ftLastWriteTime );
+        key.fDevice = 0;
+        key.fInode = static_cast< quint64 >( toNSecs( data.ftCreationTime ) );
+#else
+        struct stat info;
+        if ( stat( QFile::encodeName( path ).constData(), &info ) != 0 )
+            return false;
+#ifdef Q_OS_MACOS
+        key.fMTime = static_cast< qint64 >( info.st_mtimespec.tv_sec ) * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+        key.fMTime = static_cast< qint64 >( info.st_mtim.tv_sec ) * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+        key.fDevice = static_cast< quint64 >( info.st_dev );
+        key.fInode = static_cast< quint64 >( info.st_ino );
+#endif
+        return true;
+    }
+}
@@ -0,0 +1,85 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SOURCESCANCACHE_H
+#define __SOURCESCANCACHE_H
+
+#include <QString>
+#include <QtGlobal>
+#include <unordered_map>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    struct SScanDirEntry
+    {
+        QString fName;
+        bool fIsDir{ false };
+    };
+
+    // what identifies one version of a directory, a directory's modification time changes whenever
+    // an entry is added, removed or renamed in it
+    struct SScanDirKey
+    {
+        qint64 fMTime{ 0 }; // nanoseconds since the epoch
+        quint64 fDevice{ 0 };
+        quint64 fInode{ 0 }; // the creation time on Windows, which has no inode without opening the directory
+
+        bool operator==( const SScanDirKey & rhs ) const { return ( fMTime == rhs.fMTime ) && ( fDevice == rhs.fDevice ) && ( fInode == rhs.fInode ); }
+        bool operator!=( const SScanDirKey & rhs ) const { return !operator==( rhs ); }
+    };
+
+    struct SScanCachedDir
+    {
+        SScanDirKey fKey;
+        std::vector< SScanDirEntry > fEntries;
+    };
+
+    // The listing of every directory of the last source scan, saved next to the settings file.  A
+    // rescan stats each directory and reuses its cached entries when the key still matches, so an
+    // unchanged tree costs one stat per directory instead of one listing.  Directories are still
+    // all visited, a change deep in the tree does not touch the modification times above it.
+    // Only the listings are cached, the classification is redone from them with the current settings.
+    class CSourceScanCache
+    {
+    public:
+        CSourceScanCache( const QString & fileName, const QString & sourceDir );
+
+        bool load(); // false when there is no usable cache, the cache is then empty
+        bool save() const;
+
+        // null when the directory is not cached, or changed since, or changed too close to when the
+        // cache was written for its modification time to be trusted
+        const std::vector< SScanDirEntry > * findEntries( const QString & relPath, const SScanDirKey & key ) const;
+        void setDirs( std::unordered_map< QString, SScanCachedDir > && dirs, qint64 scannedAt );
+
+        static bool statDirectory( const QString & path, SScanDirKey & key );
+        static qint64 now(); // the same clock as SScanDirKey::fMTime
+    private:
+        QString fFileName;
+        QString fSourceDir;
+        qint64 fScannedAt{ 0 }; // when the cached scan started
+        std::unordered_map< QString, SScanCachedDir > fDirs; // by the path relative to the source dir
+    };
+}
+
+#endif
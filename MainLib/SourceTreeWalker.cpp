@@ -0,0 +1,363 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SourceTreeWalker.h"
+#include "FileClassifier.h"
+
+#include <QFile>
+
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#ifdef Q_OS_WIN
+#include <qt_windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace NVSProjectMaker
+{
+    struct CSourceTreeWalker::SWorkerQueue
+    {
+        std::mutex fMutex;
+        std::deque< STask > fTasks;
+        std::vector< std::pair< QString, SScanCachedDir > > fListings; // for the next cache, only the owning worker touches it
+    };
+
+    CSourceTreeWalker::CSourceTreeWalker( const std::shared_ptr< const SScanSettings > & settings, const QDir & sourceDir ) :
+        fSettings( settings ),
+        fSourceDir( sourceDir )
+    {
+    }
+
+    bool CSourceTreeWalker::walk( const QString & dir, const std::shared_ptr< SSourceFileInfo > & root, int numThreads )
+    {
+        if ( numThreads <= 0 )
+            numThreads = std::max( 1, static_cast< int >( std::thread::hardware_concurrency() ) );
+
+        fPending = 1;
+        fNumDirs = 0;
+        fNumFiles = 0;
+        fNumListed = 0;
+        fNumReused = 0;
+        fGitIgnores.clear();
+        auto scannedAt = CSourceScanCache::now();
+
+        std::vector< std::unique_ptr< SWorkerQueue > > queues;
+        for ( int ii = 0; ii < numThreads; ++ii )
+            queues.push_back( std::make_unique< SWorkerQueue >() );
+        auto rootRelPath = fSourceDir.relativeFilePath( dir );
+        if ( rootRelPath == "." )
+            rootRelPath.clear();
+        std::shared_ptr< const CScanRules > gitIgnore;
+        if ( fSettings->honorGitIgnore() && !rootRelPath.isEmpty() )
+            gitIgnore = CScanRules::loadGitIgnores( fSourceDir, rootRelPath.left( std::max( 0, rootRelPath.lastIndexOf( '/' ) ) ) );
+        queues.front()->fTasks.push_back( { root, dir, rootRelPath, gitIgnore } );
+
+        // the calling thread is the first worker
+        std::list< std::future< void > > workers;
+        for ( size_t ii = 1; ii < queues.size(); ++ii )
+            workers.push_back( std::async( std::launch::async, [this, ii, &queues]() { runWorker( ii, queues ); } ) );
+        runWorker( 0, queues );
+        for ( auto && ii : workers )
+            ii.get();
+        fCurrentDir = nullptr; // the tree may be cleared once the walk is over
+        if ( isCanceled() )
+            return false;
+
+        if ( fCache )
+        {
+            std::unordered_map< QString, SScanCachedDir > listings;
+            for ( auto && ii : queues )
+            {
+                for ( auto && jj : ii->fListings )
+                    listings[ jj.first ] = std::move( jj.second );
+            }
+            fCache->setDirs( std::move( listings ), scannedAt );
+        }
+        return true;
+    }
+
+    void CSourceTreeWalker::runWorker( size_t self, std::vector< std::unique_ptr< SWorkerQueue > > & queues )
+    {
+        while ( !isCanceled() )
+        {
+            STask task;
+            if ( !popTask( self, queues, task ) )
+            {
+                if ( fPending == 0 )
+                    return;
+                std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) ); // the others are still listing, and may queue more
+                continue;
+            }
+            listDirectory( task, *queues[ self ] );
+            fPending--;
+        }
+    }
+
+    // the own queue is used as a stack, which keeps a worker in one subtree, stealing takes the
+    // oldest task, which is the highest directory and so the most work
+    bool CSourceTreeWalker::popTask( size_t self, std::vector< std::unique_ptr< SWorkerQueue > > & queues, STask & task ) const
+    {
+        {
+            auto && own = *queues[ self ];
+            std::lock_guard< std::mutex > lock( own.fMutex );
+            if ( !own.fTasks.empty() )
+            {
+                task = std::move( own.fTasks.back() );
+                own.fTasks.pop_back();
+                return true;
+            }
+        }
+        for ( size_t ii = 1; ii < queues.size(); ++ii )
+        {
+            auto && victim = *queues[ ( self + ii ) % queues.size() ];
+            std::lock_guard< std::mutex > lock( victim.fMutex );
+            if ( !victim.fTasks.empty() )
+            {
+                task = std::move( victim.fTasks.front() );
+                victim.fTasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Hidden and system entries are skipped, the same as a QDir listing without QDir::Hidden and
+    // QDir::System.  Only links need a stat, to find out what they point to.
+    bool CSourceTreeWalker::readDirectory( const QString & path, std::vector< SScanDirEntry > & entries )
+    {
+#ifdef Q_OS_WIN
+        WIN32_FIND_DATAW data;
+        auto pattern = QDir::toNativeSeparators( path + "/*" );
+        auto handle = FindFirstFileExW( reinterpret_cast< LPCWSTR >( pattern.utf16() ), FindExInfoBasic, &data, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH );
+        if ( handle == INVALID_HANDLE_VALUE )
+            return false;
+        do
+        {
+            auto name = QString::fromWCharArray( data.cFileName );
+            if ( ( name == "." ) || ( name == ".." ) )
+                continue;
+            if ( data.dwFileAttributes & ( FILE_ATTRIBUTE_HIDDEN | FILE_ATTRIBUTE_SYSTEM ) )
+                continue;
+            entries.push_back( { name, ( data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY ) != 0 } );
+        }
+        while ( FindNextFileW( handle, &data ) );
+        FindClose( handle );
+#else
+        auto encodedPath = QFile::encodeName( path );
+        auto dir = opendir( encodedPath.constData() );
+        if ( !dir )
+            return false;
+        while ( auto entry = readdir( dir ) )
+        {
+            if ( entry->d_name[ 0 ] == '.' ) // hidden, and the . and .. entries
+                continue;
+
+            auto type = entry->d_type;
+            if ( ( type == DT_LNK ) || ( type == DT_UNKNOWN ) )
+            {
+                struct stat info;
+                if ( stat( ( encodedPath + "/" + entry->d_name ).constData(), &info ) != 0 )
+                    continue; // a broken link
+                type = S_ISDIR( info.st_mode ) ? DT_DIR : ( S_ISREG( info.st_mode ) ? DT_REG : DT_UNKNOWN );
+            }
+            if ( ( type != DT_DIR ) && ( type != DT_REG ) )
+                continue;
+            entries.push_back( { QFile::decodeName( entry->d_name ), type == DT_DIR } );
+        }
+        closedir( dir );
+#endif
+        return true;
+    }
+
+    // a build dir has a makefile or was named in the settings, an include dir is named incl,
+    // was named in the settings, or has a header directly in it
+    void CSourceTreeWalker::classifyDirectory( const std::shared_ptr< SSourceFileInfo > & node, const QString & relPath, const std::vector< SScanDirEntry > & entries ) const
+    {
+#ifdef Q_OS_WIN
+        auto caseSensitivity = Qt::CaseInsensitive;
+#else
+        auto caseSensitivity = Qt::CaseSensitive;
+#endif
+        node->fIsBuildDir = fSettings->isBuildDir( relPath );
+        node->fIsIncludeDir = ( node->fName == QLatin1String( "incl" ) ) || fSettings->isInclDir( relPath );
+        for ( auto && ii : entries )
+        {
+            if ( node->fIsBuildDir && node->fIsIncludeDir )
+                break;
+            if ( !node->fIsBuildDir )
+            {
+                node->fIsBuildDir = ( ii.fName.compare( "subdir.mk", caseSensitivity ) == 0 )
+                    || ( ii.fName.compare( "Makefile", caseSensitivity ) == 0 )
+                    || ( ii.fName.compare( "makefile.inc", caseSensitivity ) == 0 );
+            }
+            if ( !node->fIsIncludeDir && !ii.fIsDir )
+                node->fIsIncludeDir = CFileClassifier::marksInclDir( ii.fName );
+        }
+
+        auto executables = fSettings->getExecutables( relPath );
+        node->fExecutables = executables ? *executables : std::list< std::pair< QString, bool > >();
+    }
+
+    void CSourceTreeWalker::listDirectory( const STask & task, SWorkerQueue & queue )
+    {
+        fCurrentDir.store( task.fNode.get(), std::memory_order_release );
+
+        // the key is taken before the listing, a change made while listing makes the key stale rather than the entries
+        SScanDirKey key;
+        auto haveKey = fCache && CSourceScanCache::statDirectory( task.fPath, key );
+        auto cached = haveKey ? fCache->findEntries( task.fRelPath, key ) : nullptr;
+
+        std::vector< SScanDirEntry > entries;
+        if ( cached )
+        {
+            entries = *cached;
+            fNumReused++;
+        }
+        else
+        {
+            if ( !readDirectory( task.fPath, entries ) )
+                return;
+            fNumListed++;
+        }
+        if ( isCanceled() )
+            return;
+
+        if ( !task.fRelPath.isEmpty() ) // the source dir itself is never a project
+            classifyDirectory( task.fNode, task.fRelPath, entries );
+
+        if ( !cached )
+            std::sort( entries.begin(), entries.end(), []( const SScanDirEntry & lhs, const SScanDirEntry & rhs ) { return lhs.fName < rhs.fName; } );
+
+        auto gitIgnore = task.fGitIgnore;
+        if ( fSettings->honorGitIgnore() )
+        {
+            auto rules = CScanRules::loadGitIgnore( task.fPath, task.fRelPath, gitIgnore );
+            if ( rules != gitIgnore )
+            {
+                std::lock_guard< std::mutex > lock( fGitIgnoresMutex );
+                fGitIgnores.push_back( rules );
+                gitIgnore = rules;
+            }
+        }
+
+        std::vector< STask > dirs;
+        int numFiles = 0;
+        for ( auto && ii : entries )
+        {
+            auto relPath = task.fRelPath.isEmpty() ? ii.fName : ( task.fRelPath + "/" + ii.fName );
+            if ( !ii.fIsDir && fSettings->isGeneratedFile( relPath ) )
+                continue;
+            if ( fSettings->isIgnored( relPath, ii.fIsDir, gitIgnore.get() ) )
+                continue;
+
+            auto node = std::make_shared< SSourceFileInfo >();
+            node->fName = ii.fName;
+            node->fParent = task.fNode.get();
+            node->fIsDir = ii.fIsDir;
+            task.fNode->fChildren.push_back( node );
+            if ( ii.fIsDir )
+                dirs.push_back( { node, task.fPath + "/" + ii.fName, relPath, gitIgnore } );
+            else
+                numFiles++;
+        }
+        fNumDirs += static_cast< int >( dirs.size() );
+        fNumFiles += numFiles;
+        if ( haveKey )
+            queue.fListings.emplace_back( task.fRelPath, SScanCachedDir{ key, std::move( entries ) } );
+        if ( dirs.empty() )
+            return;
+
+        fPending += static_cast< int >( dirs.size() );
+        std::lock_guard< std::mutex > lock( queue.fMutex );
+        for ( auto ii = dirs.rbegin(); ii != dirs.rend(); ++ii ) // the first child is taken next
+            queue.fTasks.push_back( std::move( *ii ) );
+    }
+
+    QString CSourceTreeWalker::currentDir() const
+    {
+        auto dir = fCurrentDir.load( std::memory_order_acquire );
+        return dir ? dir->relPath() : QString();
+    }
+
+    QStringList CSourceTreeWalker::getSkippedText() const
+    {
+        auto retVal = fSettings->scanRules()->getSkippedText();
+        std::lock_guard< std::mutex > lock( fGitIgnoresMutex );
+        for ( auto && ii : fGitIgnores )
+            retVal << ii->getSkippedText();
+        return retVal;
+    }
+
+    void CSourceTreeWalker::collectResults( const std::shared_ptr< SSourceFileInfo > & root, SSourceFileResults & results, const std::function< void( const QString & msg ) > & logit )
+    {
+        CRelPathCache paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { root };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            if ( curr != root )
+            {
+                if ( !curr->fIsDir )
+                {
+                    results.fFiles++;
+                    continue;
+                }
+                results.fDirs++;
+                if ( curr->fIsBuildDir )
+                    results.fBuildDirs.push_back( paths.relPath( curr.get() ) );
+                if ( curr->fIsIncludeDir )
+                    results.fInclDirs.push_back( paths.relPath( curr.get() ) );
+                results.fExecutables.insert( results.fExecutables.end(), curr->fExecutables.begin(), curr->fExecutables.end() );
+            }
+            if ( logit )
+                logit( paths.relPath( curr.get() ) );
+            stack.insert( stack.end(), curr->fChildren.rbegin(), curr->fChildren.rend() );
+        }
+    }
+
+    QStringList CSourceTreeWalker::listing( const std::shared_ptr< SSourceFileInfo > & root )
+    {
+        QStringList retVal;
+        CRelPathCache paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { root };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            QStringList execNames;
+            for ( auto && ii : curr->fExecutables )
+                execNames << ii.first;
+            retVal << QString( "%1 %2%3%4 %5" ).arg( paths.relPath( curr.get() ) ).arg( curr->fIsDir ? "D" : "F" ).arg( curr->fIsBuildDir ? "B" : "" ).arg( curr->fIsIncludeDir ? "I" : "" ).arg( execNames.join( "," ) );
+            stack.insert( stack.end(), curr->fChildren.rbegin(), curr->fChildren.rend() );
+        }
+        return retVal;
+    }
+}
@@ -0,0 +1,119 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SOURCETREEWALKER_H
+#define __SOURCETREEWALKER_H
+
+#include "Settings.h"
+#include "ScanRules.h"
+#include "SourceScanCache.h"
+
+#include <QDir>
+#include <QString>
+#include <QStringList>
+#include <atomic>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace NVSProjectMaker
+{
+    // Stops a walk from any thread, the workers check it before each directory they list
+    class CScanCancelToken
+    {
+    public:
+        void cancel() { fCanceled = true; }
+        bool isCanceled() const { return fCanceled; }
+    private:
+        std::atomic< bool > fCanceled{ false };
+    };
+
+    // Walks the source tree with every directory listing a task on a work stealing pool.  Each
+    // worker takes its newest task first and steals the oldest task of another worker when it
+    // runs dry, so deep and wide trees both keep the threads busy.  Only the task listing a
+    // directory writes its children, and they are sorted by name, so the tree is the same for
+    // any number of threads.
+    //
+    // Every directory is read exactly once, with readdir or FindFirstFileEx, and whether it is a
+    // build or an include directory is decided from that listing rather than by probing for files.
+    // With a cache, a directory that has not changed since the last scan is not read at all.
+    //
+    // Entries skipped by the scan rules are dropped before their directory is queued, so an
+    // ignored subtree is never listed.
+    //
+    // A walk blocks the calling thread, which takes part as a worker, and never touches the GUI.
+    // Its progress is published through atomics, so another thread can sample it while it runs.
+    class CSourceTreeWalker
+    {
+    public:
+        CSourceTreeWalker( const std::shared_ptr< const SScanSettings > & settings, const QDir & sourceDir );
+
+        void setCache( const std::shared_ptr< CSourceScanCache > & cache ) { fCache = cache; } // read during the walk, and replaced with its listings when the walk finishes
+        void setCancelToken( const std::shared_ptr< const CScanCancelToken > & token ) { fCancelToken = token; }
+        bool walk( const QString & dir, const std::shared_ptr< SSourceFileInfo > & root, int numThreads = 0 ); // 0 uses one thread per core, false when canceled
+
+        // safe to call from any thread during the walk
+        int numDirs() const { return fNumDirs; }
+        int numFiles() const { return fNumFiles; }
+        QString currentDir() const; // the directory most recently started, relative to the source dir
+        int numListed() const { return fNumListed; }
+        int numReused() const { return fNumReused; } // directories taken from the cache
+        QStringList getSkippedText() const; // what each scan rule, the project's and the .gitignore files', skipped
+
+        // fills in the counts and the build, incl and executable lists in the order of a depth first walk
+        static void collectResults( const std::shared_ptr< SSourceFileInfo > & root, SSourceFileResults & results, const std::function< void( const QString & msg ) > & logit );
+        static QStringList listing( const std::shared_ptr< SSourceFileInfo > & root ); // one line per node with its attributes, for comparing walks
+        static bool readDirectory( const QString & path, std::vector< SScanDirEntry > & entries ); // unsorted, false when it can not be read
+        void classifyDirectory( const std::shared_ptr< SSourceFileInfo > & node, const QString & relPath, const std::vector< SScanDirEntry > & entries ) const; // from the directory's own listing
+    private:
+        struct STask
+        {
+            std::shared_ptr< SSourceFileInfo > fNode;
+            QString fPath;
+            QString fRelPath; // relative to the source dir, empty for the source dir itself
+            std::shared_ptr< const CScanRules > fGitIgnore; // the .gitignore rules of the directories above
+        };
+        struct SWorkerQueue;
+
+        void runWorker( size_t self, std::vector< std::unique_ptr< SWorkerQueue > > & queues );
+        bool popTask( size_t self, std::vector< std::unique_ptr< SWorkerQueue > > & queues, STask & task ) const;
+        void listDirectory( const STask & task, SWorkerQueue & queue );
+        bool isCanceled() const { return fCancelToken && fCancelToken->isCanceled(); }
+
+        std::shared_ptr< const SScanSettings > fSettings;
+        QDir fSourceDir;
+        std::shared_ptr< CSourceScanCache > fCache;
+        std::atomic< int > fPending{ 0 }; // queued and running tasks, the walk is done when it drops to zero
+        std::atomic< int > fNumDirs{ 0 };
+        std::atomic< int > fNumFiles{ 0 };
+        std::atomic< int > fNumListed{ 0 };
+        std::atomic< int > fNumReused{ 0 };
+        std::shared_ptr< const CScanCancelToken > fCancelToken;
+        std::atomic< const SSourceFileInfo * > fCurrentDir{ nullptr }; // its name and parent never change once it is queued
+        mutable std::mutex fGitIgnoresMutex;
+        std::list< std::shared_ptr< const CScanRules > > fGitIgnores; // every .gitignore read, for the report
+    };
+}
+
+#endif
@@ -0,0 +1,295 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SourceTreeWatcher.h"
+#include "SourceTreeWalker.h"
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QObject>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace NVSProjectMaker
+{
+    static const int kQuietMSecs = 250; // the tree must be this quiet before it is updated
+    static const qint64 kMaxDelayMSecs = 2000; // unless the changes have been pending this long, a build writing steadily still gets updates
+
+    CSourceTreeWatcher::CSourceTreeWatcher( CSettings * settings, const QDir & sourceDir, const TChangedFunc & changed, const TFailedFunc & failed ) :
+        fSettings( settings ),
+        fSourceDir( sourceDir ),
+        fChanged( changed ),
+        fFailed( failed )
+    {
+    }
+
+    CSourceTreeWatcher::~CSourceTreeWatcher()
+    {
+        stop();
+    }
+
+    std::pair< bool, QString > CSourceTreeWatcher::start()
+    {
+        stop();
+
+        fWatcher = std::make_unique< QFileSystemWatcher >();
+        fQuietTimer = std::make_unique< QTimer >();
+        fQuietTimer->setSingleShot( true );
+        fQuietTimer->setInterval( kQuietMSecs );
+        QObject::connect( fQuietTimer.get(), &QTimer::timeout, [this]() { applyChanges(); } );
+        QObject::connect( fWatcher.get(), &QFileSystemWatcher::directoryChanged, [this]( const QString & path ) { slotDirectoryChanged( path ); } );
+
+        fScanSettings = fSettings->getScanSettings();
+        if ( !watchTree( fSettings->getResults()->fRootDir ) )
+        {
+            auto numDirs = fDirs.size();
+            stop();
+            return std::make_pair( false, QObject::tr( "Could not watch all %1 source directories, the watch limit (fs.inotify.max_user_watches on Linux) is probably too low.  Watching is off, rescan to pick up changes." ).arg( numDirs ) );
+        }
+        return std::make_pair( true, QObject::tr( "Watching %1 source directories for changes" ).arg( fDirs.size() ) );
+    }
+
+    // called from the watcher's and the timer's own signals, so they are deleted once those return
+    void CSourceTreeWatcher::stop()
+    {
+        if ( fWatcher )
+        {
+            fWatcher->disconnect();
+            fWatcher.release()->deleteLater();
+        }
+        if ( fQuietTimer )
+        {
+            fQuietTimer->disconnect();
+            fQuietTimer.release()->deleteLater();
+        }
+        fDirs.clear();
+        fPending.clear();
+        fScanSettings.reset();
+    }
+
+    void CSourceTreeWatcher::fail( const QString & msg )
+    {
+        stop();
+        if ( fFailed )
+            fFailed( msg );
+    }
+
+    QString CSourceTreeWatcher::absolutePath( const std::shared_ptr< SSourceFileInfo > & dir ) const
+    {
+        return dir->fParent ? fSourceDir.absoluteFilePath( dir->relPath() ) : fSourceDir.absolutePath();
+    }
+
+    bool CSourceTreeWatcher::watchTree( const std::shared_ptr< SSourceFileInfo > & dir )
+    {
+        QStringList paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { dir };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            auto path = QDir::cleanPath( absolutePath( curr ) );
+            fDirs[ path ] = curr;
+            paths << path;
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( ii->fIsDir )
+                    stack.push_back( ii );
+            }
+        }
+        return fWatcher->addPaths( paths ).isEmpty();
+    }
+
+    void CSourceTreeWatcher::unwatchTree( const std::shared_ptr< SSourceFileInfo > & dir )
+    {
+        QStringList paths;
+        std::vector< std::shared_ptr< SSourceFileInfo > > stack = { dir };
+        while ( !stack.empty() )
+        {
+            auto curr = stack.back();
+            stack.pop_back();
+            auto path = QDir::cleanPath( absolutePath( curr ) );
+            fDirs.erase( path );
+            paths << path;
+            for ( auto && ii : curr->fChildren )
+            {
+                if ( ii->fIsDir )
+                    stack.push_back( ii );
+            }
+        }
+        fWatcher->removePaths( paths ); // the watches of deleted directories are already gone
+    }
+
+    void CSourceTreeWatcher::slotDirectoryChanged( const QString & path )
+    {
+        if ( !fQuietTimer )
+            return;
+        if ( fPending.empty() )
+            fPendingSince.start();
+        fPending.insert( QDir::cleanPath( path ) );
+        if ( !fQuietTimer->isActive() || ( fPendingSince.elapsed() < kMaxDelayMSecs ) )
+            fQuietTimer->start();
+    }
+
+    void CSourceTreeWatcher::applyChanges()
+    {
+        auto pending = std::move( fPending );
+        fPending.clear();
+
+        std::list< SSourceTreeChange > changes;
+        for ( auto && ii : pending )
+        {
+            auto pos = fDirs.find( ii );
+            if ( pos == fDirs.end() ) // removed along with its parent
+                continue;
+            if ( !updateDirectory( ii, ( *pos ).second, changes ) )
+            {
+                fail( QObject::tr( "Could not watch the new directories under '%1', the watch limit (fs.inotify.max_user_watches on Linux) is probably too low.  Watching is off, rescan to pick up changes." ).arg( ii ) );
+                return;
+            }
+        }
+        if ( changes.empty() )
+            return;
+
+        updateResults();
+        if ( fChanged )
+            fChanged( changes );
+    }
+
+    std::shared_ptr< SSourceFileInfo > CSourceTreeWatcher::addNode( const std::shared_ptr< SSourceFileInfo > & dir, const QString & name, bool isDir )
+    {
+        auto retVal = std::make_shared< SSourceFileInfo >();
+        retVal->fName = name;
+        retVal->fParent = dir.get();
+        retVal->fIsDir = isDir;
+        if ( isDir )
+            CSourceTreeWalker( fScanSettings, fSourceDir ).walk( absolutePath( retVal ), retVal, 1 );
+        return retVal;
+    }
+
+    // both the children and the new listing are sorted by name, so one merge pass finds every difference
+    bool CSourceTreeWatcher::updateDirectory( const QString & path, const std::shared_ptr< SSourceFileInfo > & dir, std::list< SSourceTreeChange > & changes )
+    {
+        std::vector< SScanDirEntry > entries;
+        if ( !CSourceTreeWalker::readDirectory( path, entries ) )
+            return true; // removed, its parent's change removes it from the tree
+        std::sort( entries.begin(), entries.end(), []( const SScanDirEntry & lhs, const SScanDirEntry & rhs ) { return lhs.fName < rhs.fName; } );
+
+        auto dirRelPath = dir->relPath();
+        auto gitIgnore = fScanSettings->honorGitIgnore() ? CScanRules::loadGitIgnores( fSourceDir, dirRelPath ) : std::shared_ptr< const CScanRules >();
+        std::vector< std::pair< QString, bool > > wanted;
+        for ( auto && ii : entries )
+        {
+            auto relPath = dirRelPath.isEmpty() ? ii.fName : ( dirRelPath + "/" + ii.fName );
+            if ( !ii.fIsDir && fScanSettings->isGeneratedFile( relPath ) )
+                continue;
+            if ( !fScanSettings->isIgnored( relPath, ii.fIsDir, gitIgnore.get() ) )
+                wanted.emplace_back( ii.fName, ii.fIsDir );
+        }
+
+        auto numChanges = changes.size();
+        auto && children = dir->fChildren;
+        auto curr = children.begin();
+        int row = 0;
+        size_t next = 0;
+        while ( ( curr != children.end() ) || ( next < wanted.size() ) )
+        {
+            bool remove = false;
+            bool add = false;
+            if ( curr == children.end() )
+                add = true;
+            else if ( next == wanted.size() )
+                remove = true;
+            else if ( ( *curr )->fName < wanted[ next ].first )
+                remove = true;
+            else if ( wanted[ next ].first < ( *curr )->fName )
+                add = true;
+            else if ( ( *curr )->fIsDir != wanted[ next ].second )
+                remove = add = true; // a file replaced by a directory of the same name, or the other way around
+            else
+            {
+                ++curr;
+                ++row;
+                ++next;
+                continue;
+            }
+
+            if ( remove )
+            {
+                if ( ( *curr )->fIsDir )
+                    unwatchTree( *curr );
+                changes.push_back( { SSourceTreeChange::EType::eRemoved, dir, *curr, row } );
+                curr = children.erase( curr );
+            }
+            if ( add )
+            {
+                auto node = addNode( dir, wanted[ next ].first, wanted[ next ].second );
+                if ( node->fIsDir )
+                {
+                    markDirty( node );
+                    if ( !watchTree( node ) )
+                        return false;
+                }
+                children.insert( curr, node );
+                changes.push_back( { SSourceTreeChange::EType::eAdded, dir, node, row } );
+                ++row;
+                ++next;
+            }
+        }
+
+        // a new makefile or header can make the directory a build or include dir
+        if ( dir->fParent )
+        {
+            auto wasBuildDir = dir->fIsBuildDir;
+            auto wasInclDir = dir->fIsIncludeDir;
+            auto executables = dir->fExecutables;
+            CSourceTreeWalker( fScanSettings, fSourceDir ).classifyDirectory( dir, dirRelPath, entries );
+            if ( ( wasBuildDir != dir->fIsBuildDir ) || ( wasInclDir != dir->fIsIncludeDir ) || ( executables != dir->fExecutables ) )
+                changes.push_back( { SSourceTreeChange::EType::eReclassified, nullptr, dir, 0 } );
+        }
+
+        if ( changes.size() != numChanges )
+            markDirty( dir );
+        return true;
+    }
+
+    // incl and src dirs with a peer belong to the project of their parent, the source dir itself is not a project
+    void CSourceTreeWatcher::markDirty( const std::shared_ptr< SSourceFileInfo > & dir )
+    {
+        auto relPath = dir->relPath();
+        if ( dir->isPairedInclSrcDir() )
+            relPath = dir->fParent->relPath();
+        if ( !relPath.isEmpty() )
+            fDirtyProjects.insert( relPath );
+    }
+
+    void CSourceTreeWatcher::updateResults()
+    {
+        auto results = fSettings->getResults();
+        results->fDirs = 0;
+        results->fFiles = 0;
+        results->fBuildDirs.clear();
+        results->fInclDirs.clear();
+        results->fExecutables.clear();
+        CSourceTreeWalker::collectResults( results->fRootDir, *results, {} );
+    }
+}
@@ -0,0 +1,108 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef __SOURCETREEWATCHER_H
+#define __SOURCETREEWATCHER_H
+
+#include "Settings.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include <list>
+#include <memory>
+#include <set>
+#include <unordered_map>
+
+class QFileSystemWatcher;
+class QTimer;
+
+namespace NVSProjectMaker
+{
+    struct SSourceTreeChange
+    {
+        enum class EType
+        {
+            eAdded,
+            eRemoved,
+            eReclassified // the directory's build, incl or executable flags changed
+        };
+        EType fType{ EType::eAdded };
+        std::shared_ptr< SSourceFileInfo > fParent; // null for eReclassified
+        std::shared_ptr< SSourceFileInfo > fNode;
+        int fRow{ 0 }; // in the parent's children, when the change was made
+    };
+
+    // Keeps the scanned SSourceFileInfo tree current after the scan.  Every directory is watched
+    // with a QFileSystemWatcher, which is backed by inotify on Linux.  Change notifications are
+    // collected until the tree has been quiet for a moment, then each changed directory is listed
+    // again and compared with its children, so a burst of events is one update and a rename is a
+    // remove and an add.  New directories are walked and watched, removed ones are unwatched.
+    //
+    // When a watch can not be added, usually because fs.inotify.max_user_watches is too low, the
+    // watcher stops and reports it, the tree is then only updated by a rescan.
+    class CSourceTreeWatcher
+    {
+    public:
+        using TChangedFunc = std::function< void( const std::list< SSourceTreeChange > & changes ) >;
+        using TFailedFunc = std::function< void( const QString & msg ) >;
+
+        CSourceTreeWatcher( CSettings * settings, const QDir & sourceDir, const TChangedFunc & changed, const TFailedFunc & failed );
+        ~CSourceTreeWatcher();
+
+        std::pair< bool, QString > start();
+        void stop();
+        bool isActive() const { return fWatcher != nullptr; }
+
+        // the projects, by the directory their SDirInfo is made for, with a change since the last generate
+        const TStringSet & dirtyProjects() const { return fDirtyProjects; }
+        void clearDirtyProjects() { fDirtyProjects.clear(); }
+    private:
+        void slotDirectoryChanged( const QString & path );
+        void applyChanges();
+        bool updateDirectory( const QString & path, const std::shared_ptr< SSourceFileInfo > & dir, std::list< SSourceTreeChange > & changes );
+        std::shared_ptr< SSourceFileInfo > addNode( const std::shared_ptr< SSourceFileInfo > & dir, const QString & name, bool isDir );
+        void updateResults();
+        bool watchTree( const std::shared_ptr< SSourceFileInfo > & dir );
+        void unwatchTree( const std::shared_ptr< SSourceFileInfo > & dir );
+        void markDirty( const std::shared_ptr< SSourceFileInfo > & dir );
+        QString absolutePath( const std::shared_ptr< SSourceFileInfo > & dir ) const;
+        void fail( const QString & msg );
+
+        CSettings * fSettings{ nullptr };
+        QDir fSourceDir;
+        TChangedFunc fChanged;
+        TFailedFunc fFailed;
+
+        std::unique_ptr< QFileSystemWatcher > fWatcher;
+        std::unique_ptr< QTimer > fQuietTimer;
+        std::shared_ptr< const SScanSettings > fScanSettings;
+        std::unordered_map< QString, std::shared_ptr< SSourceFileInfo > > fDirs; // the watched directories by absolute path
+        std::set< QString > fPending; // changed since the last update, sorted so parents come before their children
+        QElapsedTimer fPendingSince;
+        TStringSet fDirtyProjects;
+    };
+}
+
+#endif
@@ -25,22 +25,51 @@ set(USE_QT TRUE)
 set(FOLDER_NAME Apps)
 
 set(qtproject_SRCS
+    BinLogReader.cpp
     BuildinfoData.cpp
+    BuildInfoDatabase.cpp
+    BuildOutputReader.cpp
     DirInfo.cpp
+    ExecJournalReader.cpp
+    FlatSourceTree.cpp
+    FlagFactoring.cpp
+    IncludeScanner.cpp
+    MakeDryRun.cpp
+    PchRecommender.cpp
     DebugTarget.cpp
     VSProjectMaker.cpp
+    ScanRules.cpp
     Settings.cpp
+    SourceBuildJoin.cpp
+    SourceScanCache.cpp
+    SourceTreeWalker.cpp
+    SourceTreeWatcher.cpp
 )
 
 set(qtproject_H
 )
 
 set(project_H
+    BinLogReader.h
     BuildinfoData.h
+    BuildInfoDatabase.h
+    BuildOutputReader.h
     DirInfo.h
+    ExecJournalReader.h
+    FileClassifier.h
+    FlatSourceTree.h
+    FlagFactoring.h
+    IncludeScanner.h
+    MakeDryRun.h
+    PchRecommender.h
     DebugTarget.h
     VSProjectMaker.h
+    ScanRules.h
     Settings.h
+    SourceBuildJoin.h
+    SourceScanCache.h
+    SourceTreeWalker.h
+    SourceTreeWatcher.h
     Version.h
 )
 
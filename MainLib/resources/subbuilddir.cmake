@@ -55,6 +55,8 @@ set(project_YAML_FILES
 <BUILD_FILES>
 )
 
+<PCH_HEADERS>
+
 include( ${CMAKE_BINARY_DIR}/Project.cmake )
 
 add_custom_target( <PROJECT_NAME> <ALL_SETTING>
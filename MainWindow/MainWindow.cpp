@@ -36,6 +36,11 @@
 #include "MainLib/DirInfo.h"
 #include "MainLib/Settings.h"
 #include "MainLib/BuildInfoData.h"
+#include "MainLib/BuildInfoDatabase.h"
+#include "MainLib/SourceBuildJoin.h"
+#include "MainLib/IncludeScanner.h"
+#include "MainLib/PchRecommender.h"
+#include "MainLib/SourceTreeWatcher.h"
 
 #include "SABUtils/UtilityModels.h"
 #include "SABUtils/StringUtils.h"
@@ -90,8 +95,11 @@ CMainWindow::CMainWindow( QWidget * parent )
     connect( fImpl->addDebugTargetBtn, &QToolButton::clicked, this, &CMainWindow::slotAddDebugTarget );
     connect( fImpl->bldOutputFileBtn, &QToolButton::clicked, this, &CMainWindow::slotSetBuildOutputFile );
     connect( fImpl->runBuildAnalysisBtn, &QToolButton::clicked, this, &CMainWindow::slotLoadOutputData );
+    connect( fImpl->dryRunBtn, &QToolButton::clicked, this, &CMainWindow::slotLoadDryRunData );
+    connect( fImpl->exportBldDataBtn, &QToolButton::clicked, this, &CMainWindow::slotExportBuildData );
     
     connect( fImpl->generateBtn, &QToolButton::clicked, this, &CMainWindow::slotGenerate );
+    connect( fImpl->watchSourceTree, &QCheckBox::toggled, this, &CMainWindow::slotWatchSourceTree );
     fImpl->useCustomCMake->setChecked( false );
     fSourceModel = new QStandardItemModel( this );
     fImpl->sourceTree->setModel( fSourceModel );
@@ -119,6 +127,11 @@ CMainWindow::CMainWindow( QWidget * parent )
     fBuildInfoDataModel = new QStandardItemModel( this );
     fBuildInfoDataModel->setHorizontalHeaderLabels( QStringList() << "Source Directory" << "Target Directory" << "Type" << "Primary Input File" << "Output File" );
     fImpl->bldData->setModel( fBuildInfoDataModel );
+
+    fBuildStatsModel = new QStandardItemModel( this );
+    fBuildStatsModel->setHorizontalHeaderLabels( QStringList() << "Statistic" << "Value" );
+    fImpl->bldStats->setModel( fBuildStatsModel );
+    fImpl->bldStats->setVisible( false );
     QSettings settings;
     setProjects( settings.value( "RecentProjects" ).toStringList() );
 
@@ -431,6 +444,13 @@ void CMainWindow::saveSettings()
     fSettings->setSelectedQtDirs(fQtLibsModel->getCheckedStrings());
     fSettings->setBuildOutputDataFile(fImpl->bldOutputFile->text());
     fSettings->setBldTxtProdDir(fImpl->origBldTxtProdDir->text());
+    fSettings->setDecodeOptionsOnDemand(fImpl->decodeOptionsOnDemand->isChecked());
+    fSettings->setCollectLoadStats(fImpl->collectLoadStats->isChecked());
+    fSettings->setRecommendPchHeaders(fImpl->recommendPchHeaders->isChecked());
+    fSettings->setWatchSourceTree(fImpl->watchSourceTree->isChecked());
+    fSettings->setScanRules(fImpl->scanRules->toPlainText().split('\n', Qt::SkipEmptyParts));
+    fSettings->setHonorGitIgnore(fImpl->honorGitIgnore->isChecked());
+    fSettings->setDryRunMakeCommand(fImpl->dryRunMakeCommand->text());
     fSettings->setVerbose(fImpl->verbose->isChecked());
 
     auto attribs = findDirAttributes(nullptr);
@@ -495,6 +515,13 @@ void CMainWindow::loadSettings()
     fImpl->prodDir->setText(fSettings->getProdDir());
     fImpl->msys64Dir->setText(fSettings->getMSys64Dir());
     fImpl->origBldTxtProdDir->setText(fSettings->getBldTxtProdDir());
+    fImpl->decodeOptionsOnDemand->setChecked(fSettings->getDecodeOptionsOnDemand());
+    fImpl->collectLoadStats->setChecked(fSettings->getCollectLoadStats());
+    fImpl->recommendPchHeaders->setChecked(fSettings->getRecommendPchHeaders());
+    fImpl->watchSourceTree->setChecked(fSettings->getWatchSourceTree());
+    fImpl->scanRules->setPlainText(fSettings->getScanRules().join('\n'));
+    fImpl->honorGitIgnore->setChecked(fSettings->getHonorGitIgnore());
+    fImpl->dryRunMakeCommand->setText(fSettings->getDryRunMakeCommand());
     fImpl->bldOutputFile->setText(fSettings->getBuildOutputDataFile());
     fImpl->verbose->setChecked(fSettings->getVerbose());
 
@@ -585,6 +612,7 @@ void CMainWindow::doChanged( bool andLoad )
     auto sourceDir = sourceDirPath.has_value() ? QDir( sourceDirPath.value() ) : QDir();
     if ( fSourceDir.has_value() && ( !sourceDirOK || ( fSourceDir.value() != sourceDir ) ) )
     {
+        fSourceWatcher.reset();
         fSourceModel->clear();
     }
 
@@ -600,7 +628,11 @@ void CMainWindow::doChanged( bool andLoad )
         fSourceDir = QDir();
 
     auto buildTxtFile = fSettings->getBuildOutputDataFile();
-    if ( !buildTxtFile.isEmpty() && QFileInfo( buildTxtFile ).exists() && QFileInfo( buildTxtFile ).isReadable() )
+    auto buildTxtFiles = NVSProjectMaker::CBuildInfoData::expandFileNames( buildTxtFile );
+    bool buildTxtFilesOK = !buildTxtFiles.isEmpty();
+    for ( auto && ii : buildTxtFiles )
+        buildTxtFilesOK = buildTxtFilesOK && QFileInfo( ii ).exists() && QFileInfo( ii ).isReadable();
+    if ( buildTxtFilesOK )
     {
         if ( !fBuildTextFile.has_value() || ( fBuildTextFile.has_value() && ( fBuildTextFile.value() != buildTxtFile ) ) )
         {
@@ -1199,22 +1231,26 @@ void CMainWindow::slotSelectCMake()
 
 void CMainWindow::slotSetBuildOutputFile()
 {
-    auto currPath = fImpl->bldOutputFile->text();
+    auto currPaths = NVSProjectMaker::CBuildInfoData::expandFileNames( fImpl->bldOutputFile->text() );
+    auto currPath = currPaths.isEmpty() ? QString() : currPaths.front();
     if ( currPath.isEmpty() && fSettings->getBuildDir().has_value() )
         currPath = fSettings->getBuildDir().value();
 
-    auto newPath = QFileDialog::getOpenFileName( this, tr( "Select Output Data File from Build" ), currPath, tr( "Output Data Files *.txt;;All Files *.*" ) );
-    if ( newPath.isEmpty() )
+    auto newPaths = QFileDialog::getOpenFileNames( this, tr( "Select Output Data Files from Build" ), currPath, tr( "Output Data Files *.txt *.txt.gz *.txt.zst *.gz *.zst *.binlog *.sqlite;;All Files *.*" ) );
+    if ( newPaths.isEmpty() )
         return;
 
-    QFileInfo fi( newPath );
-    if ( !fi.exists() || !fi.isFile() || !fi.isReadable() )
+    for ( auto && ii : newPaths )
     {
-        QMessageBox::critical( this, tr( "Error Readable File not Selected" ), QString( "Error: '%1' is not an readable file" ).arg( newPath ) );
-        return;
+        QFileInfo fi( ii );
+        if ( !fi.exists() || !fi.isFile() || !fi.isReadable() )
+        {
+            QMessageBox::critical( this, tr( "Error Readable File not Selected" ), QString( "Error: '%1' is not an readable file" ).arg( ii ) );
+            return;
+        }
     }
 
-    fImpl->bldOutputFile->setText( newPath );
+    fImpl->bldOutputFile->setText( newPaths.join( ";" ) );
 }
 
 void CMainWindow::appendToLog( const QString & txt )
@@ -1309,8 +1345,18 @@ void CMainWindow::slotGenerate()
     qApp->processEvents();
 
     saveSettings();
+    fSettings->setPchRecommender( nullptr );
+    if ( fSettings->getRecommendPchHeaders() )
+    {
+        auto graph = NVSProjectMaker::CIncludeScanner( fSettings.get() ).scan( fProgress );
+        if ( !graph )
+            return;
+        fSettings->setPchRecommender( std::make_shared< NVSProjectMaker::CPchRecommender >( graph, fSourceBuildJoin, fSourceDir.value().absolutePath() ) );
+    }
     if ( !fSettings->generate( fProgress, this, [this]( const QString & msg ) { appendToLog( msg ); } ) )
         return;
+    if ( fSourceWatcher )
+        fSourceWatcher->clearDirtyProjects();
 
     fProgress->setLabelText( tr( "Running CMake" ) );
     pb->setEnabled( false );
@@ -1352,7 +1398,9 @@ void CMainWindow::slotLoadSource()
 
     auto text = fSourceDir.value().dirName();
 
+    fSourceWatcher.reset();
     fSettings->getResults()->clear();
+    fSourceBuildJoin.reset();
     fSettings->getResults()->fRootDir->fName = text;
     fSettings->getResults()->fRootDir->fIsDir = true;
 
@@ -1389,15 +1437,144 @@ void CMainWindow::slotLoadSource()
         appendToLog( tr( "Finished Finding Source Files" ) );
         appendToLog( tr( "Results:" ) );
         appendToLog( fSettings->getResults()->getText( true ) );
+        joinSourceAndBuildData();
+        slotWatchSourceTree();
     }
     fImpl->tabWidget->setCurrentIndex( 0 );
 }
 
+void CMainWindow::slotWatchSourceTree()
+{
+    fSourceWatcher.reset();
+    if ( !fImpl->watchSourceTree->isChecked() || !fSourceDir.has_value() || ( fSourceModel->rowCount() == 0 ) )
+        return;
+
+    fSourceWatcher = std::make_unique< NVSProjectMaker::CSourceTreeWatcher >( fSettings.get(), fSourceDir.value(),
+        [this]( const std::list< NVSProjectMaker::SSourceTreeChange > & changes ) { applySourceTreeChanges( changes ); },
+        [this]( const QString & msg ) { appendToLog( "WARNING: " + msg ); } );
+    auto status = fSourceWatcher->start();
+    if ( !status.first )
+    {
+        appendToLog( "WARNING: " + status.second );
+        fSourceWatcher.reset();
+        return;
+    }
+    appendToLog( status.second );
+}
+
+// the rows under a directory are in the order of its children, so the path leads straight down
+QStandardItem * CMainWindow::findSourceItem( const QString & relPath ) const
+{
+    auto curr = fSourceModel->item( 0 );
+    while ( curr && !relPath.isEmpty() )
+    {
+        QStandardItem * next = nullptr;
+        for ( int ii = 0; !next && ( ii < curr->rowCount() ); ++ii )
+        {
+            auto child = curr->child( ii );
+            auto childPath = child->data( NVSProjectMaker::ERoles::eRelPathRole ).toString();
+            if ( childPath == relPath )
+                return child;
+            if ( relPath.startsWith( childPath + "/" ) )
+                next = child;
+        }
+        curr = next;
+    }
+    return curr;
+}
+
+void CMainWindow::applySourceTreeChanges( const std::list< NVSProjectMaker::SSourceTreeChange > & changes )
+{
+    int numAdded = 0;
+    int numRemoved = 0;
+    for ( auto && ii : changes )
+    {
+        switch ( ii.fType )
+        {
+            case NVSProjectMaker::SSourceTreeChange::EType::eAdded:
+                if ( auto parent = findSourceItem( ii.fParent->relPath() ) )
+                    parent->insertRow( ii.fRow, ii.fNode->createRow() );
+                numAdded++;
+                break;
+            case NVSProjectMaker::SSourceTreeChange::EType::eRemoved:
+                if ( auto parent = findSourceItem( ii.fParent->relPath() ) )
+                    parent->removeRow( ii.fRow );
+                numRemoved++;
+                break;
+            case NVSProjectMaker::SSourceTreeChange::EType::eReclassified:
+            {
+                auto item = findSourceItem( ii.fNode->relPath() );
+                if ( !item || !item->parent() )
+                    break;
+                item->setData( ii.fNode->fIsBuildDir, NVSProjectMaker::ERoles::eIsBuildDirRole );
+                item->setData( ii.fNode->fIsIncludeDir, NVSProjectMaker::ERoles::eIsIncludeDirRole );
+                item->setData( QVariant::fromValue( ii.fNode->fExecutables ), NVSProjectMaker::ERoles::eExecutablesRole );
+
+                QStringList execNames;
+                for ( auto && jj : ii.fNode->fExecutables )
+                    execNames << jj.first;
+                auto parent = item->parent();
+                parent->child( item->row(), 1 )->setText( ii.fNode->fIsBuildDir ? "Yes" : "" );
+                parent->child( item->row(), 2 )->setText( execNames.join( " " ) );
+                parent->child( item->row(), 3 )->setText( ii.fNode->fIsIncludeDir ? "Yes" : "" );
+                break;
+            }
+        }
+    }
+
+    QStringList dirtyProjects;
+    for ( auto && ii : fSourceWatcher->dirtyProjects() )
+        dirtyProjects << ii;
+    appendToLog( tr( "Source tree changed: %1 added, %2 removed.  Projects to generate again: %3" ).arg( numAdded ).arg( numRemoved ).arg( dirtyProjects.join( " " ) ) );
+}
+
 void CMainWindow::slotLoadOutputData()
+{
+    loadOutputData( {} );
+}
+
+void CMainWindow::slotLoadDryRunData()
+{
+    if ( !fSourceDir.has_value() || fSettings->getResults()->fBuildDirs.isEmpty() )
+    {
+        QMessageBox::critical( this, tr( "No Build Directories" ), tr( "Load the source directory first, make is run in the build directories it finds" ) );
+        return;
+    }
+
+    NVSProjectMaker::SMakeDryRun dryRun;
+    dryRun.fMakeCommand = fImpl->dryRunMakeCommand->text().trimmed().isEmpty() ? QString( "make" ) : fImpl->dryRunMakeCommand->text().trimmed();
+    for ( auto && ii : fSettings->getResults()->fBuildDirs )
+        dryRun.fDirs << fSourceDir.value().absoluteFilePath( ii );
+    loadOutputData( dryRun );
+}
+
+void CMainWindow::slotExportBuildData()
+{
+    if ( !fBuildInfoData )
+    {
+        QMessageBox::critical( this, tr( "No Build Data" ), tr( "Load the build output data first" ) );
+        return;
+    }
+
+    auto fileName = QFileDialog::getSaveFileName( this, tr( "Export Build Data" ), fSourceDir.has_value() ? fSourceDir.value().absolutePath() : QString(), tr( "SQLite Database *.sqlite;;All Files *.*" ) );
+    if ( fileName.isEmpty() )
+        return;
+
+    auto status = NVSProjectMaker::CBuildInfoDatabase::exportData( *fBuildInfoData, fileName );
+    if ( !status.first )
+    {
+        QMessageBox::critical( this, tr( "Could not export Build Data" ), status.second );
+        return;
+    }
+    appendToLog( tr( "Build data exported to '%1'" ).arg( fileName ) );
+}
+
+void CMainWindow::loadOutputData( const std::optional< NVSProjectMaker::SMakeDryRun > & dryRun )
 {
     fImpl->tabWidget->setCurrentIndex( 1 );
 
     fBuildInfoDataModel->clear();
+    fBuildStatsModel->removeRows( 0, fBuildStatsModel->rowCount() );
     fImpl->log->clear();
 
     auto progress = std::make_unique< QProgressDialog >( tr( "Reading Build Output..." ), tr( "Cancel" ), 0, 0, this );
@@ -1409,20 +1586,27 @@ void CMainWindow::slotLoadOutputData()
     progress->setRange( 0, 100 );
     progress->setValue( 0 );
 
-    fBuildInfoData = std::make_shared< NVSProjectMaker::CBuildInfoData >( fImpl->bldOutputFile->text(),
-                                                                          [this]( const QString & msg )
+    auto reportFunc = [this]( const QString & msg )
     {
         appendToLog( msg );
         qApp->processEvents();
-    }, fSettings.get(), progress.get() );
+    };
+    if ( dryRun.has_value() )
+        fBuildInfoData = std::make_shared< NVSProjectMaker::CBuildInfoData >( dryRun.value(), reportFunc, fSettings.get(), progress.get(), fImpl->collectLoadStats->isChecked() );
+    else
+        fBuildInfoData = std::make_shared< NVSProjectMaker::CBuildInfoData >( fImpl->bldOutputFile->text(), reportFunc, fSettings.get(), progress.get(), fImpl->collectLoadStats->isChecked() );
     if ( !fBuildInfoData->status() )
     {
         progress->close();
         QMessageBox::critical( this, tr( "Could not read Output Data File" ), fBuildInfoData->errorString() );
         fBuildInfoData.reset();
+        fSourceBuildJoin.reset();
         return;
     }
     fBuildInfoData->loadIntoTree( fBuildInfoDataModel );
+    fSettings->setGeneratedFiles( fBuildInfoData->generatedFiles() );
+    loadBuildStats();
+    joinSourceAndBuildData();
     if ( !progress->wasCanceled() && fLoadSourceAfterLoadData )
     {
         QTimer::singleShot( 0, this, &CMainWindow::slotLoadSource );
@@ -1430,6 +1614,26 @@ void CMainWindow::slotLoadOutputData()
     }
 }
 
+void CMainWindow::loadBuildStats()
+{
+    auto rows = fBuildInfoData->stats().rows();
+    for ( auto && ii : rows )
+        fBuildStatsModel->appendRow( QList< QStandardItem * >() << new QStandardItem( ii.first ) << new QStandardItem( ii.second ) );
+    fImpl->bldStats->setVisible( !rows.isEmpty() );
+    fImpl->bldStats->resizeColumnToContents( 0 );
+}
+
+void CMainWindow::joinSourceAndBuildData()
+{
+    fSourceBuildJoin.reset();
+    if ( !fBuildInfoData || !fSourceDir.has_value() || fSettings->getResults()->fRootDir->fChildren.empty() )
+        return;
+
+    fSourceBuildJoin = std::make_shared< NVSProjectMaker::CSourceBuildJoin >( fSourceDir.value(), fSettings->getResults(), *fBuildInfoData );
+    appendToLog( tr( "============================================" ) );
+    appendToLog( fSourceBuildJoin->getText( fSettings->getVerbose() ) );
+}
+
 void CMainWindow::slotBuildsChanged()
 {
     auto builds = getCustomBuilds( false );
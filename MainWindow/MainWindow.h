@@ -46,6 +46,10 @@ namespace NVSProjectMaker
     struct SDebugTarget;
     class CSettings;
     class CBuildInfoData;
+    class CSourceBuildJoin;
+    class CSourceTreeWatcher;
+    struct SSourceTreeChange;
+    struct SMakeDryRun;
     struct SSourceFileResults;
     struct SSourceFileInfo;
 }
@@ -86,7 +90,10 @@ public Q_SLOTS:
 
     void slotLoadSource();
     void slotLoadOutputData();
+    void slotLoadDryRunData();
+    void slotExportBuildData();
     void slotLoadSourceAndOutputData();
+    void slotWatchSourceTree();
 
     bool expandDirectories( QStandardItem * rootNode );
 
@@ -133,6 +140,11 @@ private:
 
     void reset();
     QStandardItem * loadSourceFileModel();
+    QStandardItem * findSourceItem( const QString & relPath ) const;
+    void applySourceTreeChanges( const std::list< NVSProjectMaker::SSourceTreeChange > & changes );
+    void loadOutputData( const std::optional< NVSProjectMaker::SMakeDryRun > & dryRun );
+    void loadBuildStats();
+    void joinSourceAndBuildData();
     void pushDisconnected();
     void popDisconnected( bool force=false );
 
@@ -170,6 +182,7 @@ private:
     std::optional< QString > fBuildTextFile;
     QStandardItemModel * fSourceModel{ nullptr };
     QStandardItemModel * fBuildInfoDataModel{ nullptr };
+    QStandardItemModel * fBuildStatsModel{ nullptr };
     NSABUtils::CCheckableStringListModel * fIncDirModel{ nullptr };
     NSABUtils::CCheckableStringListModel * fPreProcDefineModel{ nullptr };
     QStandardItemModel * fCustomBuildModel{ nullptr };
@@ -183,6 +196,8 @@ private:
 
     std::unique_ptr< NVSProjectMaker::CSettings > fSettings;
     std::shared_ptr< NVSProjectMaker::CBuildInfoData > fBuildInfoData;
+    std::shared_ptr< NVSProjectMaker::CSourceBuildJoin > fSourceBuildJoin; // only when both the source tree and the build data are loaded
+    std::unique_ptr< NVSProjectMaker::CSourceTreeWatcher > fSourceWatcher;
     QStringList fProdDirUsages;
     QPointer< QProgressDialog > fProgress;
 };
@@ -0,0 +1,93 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MainLib/BinLogReader.h"
+#include "MainLib/BuildInfoData.h"
+#include "MainLib/Settings.h"
+
+#include <QDir>
+#include <QFile>
+#include <gtest/gtest.h>
+
+namespace NVSProjectMaker
+{
+    // TestData/Sample.binlog is written by MSBuild from TestData/Sample.proj, the lines of
+    // Sample.binlog.expected are what the reader and the loader must make of it
+    class CBinLogTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            QFile file( QDir( VSPM_TEST_DATA_DIR ).absoluteFilePath( "Sample.binlog.expected" ) );
+            ASSERT_TRUE( file.open( QIODevice::ReadOnly | QIODevice::Text ) ) << file.fileName().toStdString();
+            for ( auto && ii : QString::fromUtf8( file.readAll() ).split( '\n', Qt::SkipEmptyParts ) )
+                ( ii.startsWith( "Task: " ) ? fExpectedTasks : fExpectedItems ) << ii;
+        }
+
+        void loadItems( bool decodeOnDemand )
+        {
+            CSettings settings;
+            settings.setBldTxtProdDir( "C:/prod" );
+            settings.setDecodeOptionsOnDemand( decodeOnDemand );
+            QStringList messages;
+            CBuildInfoData buildInfo( sampleFile(), [ &messages ]( const QString & msg ) { messages << msg; }, &settings, nullptr );
+            ASSERT_TRUE( buildInfo.status() ) << buildInfo.errorString().toStdString() << "\n" << messages.join( "\n" ).toStdString();
+
+            QStringList items;
+            for ( auto && ii : buildInfo.items() )
+                items << QString( "Item: %1 %2 %3" ).arg( ii->targetFile() ).arg( ii->getItemTypeName() ).arg( ii->fDurationMS );
+            items.sort();
+            items.prepend( QString( "Items: %1" ).arg( items.count() ) );
+            EXPECT_EQ( items.join( "\n" ).toStdString(), fExpectedItems.join( "\n" ).toStdString() );
+        }
+
+        static QString sampleFile() { return QDir( VSPM_TEST_DATA_DIR ).absoluteFilePath( "Sample.binlog" ); }
+
+        QStringList fExpectedTasks;
+        QStringList fExpectedItems;
+    };
+
+    TEST_F( CBinLogTest, ReadsTasks )
+    {
+        CBinLogReader reader( sampleFile() );
+        ASSERT_TRUE( reader.open() ) << reader.errorString().toStdString();
+        EXPECT_GE( reader.fileFormatVersion(), 18 );
+
+        QStringList tasks;
+        SBinLogTask task;
+        while ( reader.readTask( task ) )
+            tasks << QString( "Task: %1 %2 %3 %4" ).arg( task.fTaskName ).arg( task.fDurationMS ).arg( task.fProjectFile ).arg( task.fCommandLine.trimmed() );
+        ASSERT_TRUE( reader.status() ) << reader.errorString().toStdString();
+        EXPECT_EQ( tasks.join( "\n" ).toStdString(), fExpectedTasks.join( "\n" ).toStdString() );
+    }
+
+    TEST_F( CBinLogTest, LoadsItemsDecodedOnLoad )
+    {
+        loadItems( false );
+    }
+
+    TEST_F( CBinLogTest, LoadsItemsDecodedOnDemand )
+    {
+        loadItems( true );
+    }
+}
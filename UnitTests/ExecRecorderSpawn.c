@@ -0,0 +1,71 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+/*
+ * Test helper for the ExecRecorder test, spawns "touch chdir.txt" with a chdir file action
+ * and "touch fchdir.txt" with an fchdir file action:
+ *
+ *     ExecRecorderSpawn <chdir directory> <fchdir directory>
+ */
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <spawn.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char ** environ;
+
+static int spawnTouch( posix_spawn_file_actions_t * fileActions, char * fileName )
+{
+    char * argv[] = { "touch", fileName, NULL };
+    pid_t pid;
+    int status = 0;
+    if ( posix_spawnp( &pid, "touch", fileActions, NULL, argv, environ ) != 0 )
+        return 0;
+    return ( waitpid( pid, &status, 0 ) == pid ) && WIFEXITED( status ) && ( WEXITSTATUS( status ) == 0 );
+}
+
+int main( int argc, char ** argv )
+{
+    if ( argc != 3 )
+    {
+        fprintf( stderr, "usage: %s <chdir directory> <fchdir directory>\n", argv[ 0 ] );
+        return 2;
+    }
+
+    posix_spawn_file_actions_t fileActions;
+    posix_spawn_file_actions_init( &fileActions );
+    int aOK = ( posix_spawn_file_actions_addchdir_np( &fileActions, argv[ 1 ] ) == 0 ) && spawnTouch( &fileActions, "chdir.txt" );
+    posix_spawn_file_actions_destroy( &fileActions );
+
+    int fd = open( argv[ 2 ], O_RDONLY | O_DIRECTORY | O_CLOEXEC );
+    posix_spawn_file_actions_init( &fileActions );
+    aOK = aOK && ( fd >= 0 ) && ( posix_spawn_file_actions_addfchdir_np( &fileActions, fd ) == 0 ) && spawnTouch( &fileActions, "fchdir.txt" );
+    posix_spawn_file_actions_destroy( &fileActions );
+    if ( fd >= 0 )
+        close( fd );
+
+    return aOK ? 0 : 1;
+}
@@ -0,0 +1,119 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MainLib/ExecJournalReader.h"
+#include "ExecRecorder/ExecJournal.h"
+#include "TestUtils.h"
+
+#include <QFileInfo>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+
+namespace NVSProjectMaker
+{
+    // runs programs under the ExecRecorder library with a relative journal directory, and reads the journals back
+    class CExecRecorderTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE( QFileInfo( VSPM_EXEC_RECORDER_LIB ).isFile() ) << VSPM_EXEC_RECORDER_LIB;
+            ASSERT_TRUE( fTmpDir.isValid() );
+            // getcwd, and so the recorder, returns the path with its links resolved
+            fRoot = QDir( QFileInfo( fTmpDir.path() ).canonicalFilePath() );
+            ASSERT_TRUE( fRoot.mkpath( "journal" ) );
+        }
+
+        void run( const QString & program, const QStringList & args )
+        {
+            auto env = QProcessEnvironment::systemEnvironment();
+            env.insert( "LD_PRELOAD", VSPM_EXEC_RECORDER_LIB );
+            env.insert( EXEC_JOURNAL_DIR_ENV, "journal" );
+            QProcess process;
+            process.setProcessEnvironment( env );
+            process.setWorkingDirectory( fRoot.absolutePath() );
+            process.start( program, args );
+            ASSERT_TRUE( process.waitForStarted() ) << process.errorString().toStdString();
+            ASSERT_TRUE( process.waitForFinished( 60000 ) );
+            ASSERT_EQ( process.exitStatus(), QProcess::NormalExit );
+            ASSERT_EQ( process.exitCode(), 0 ) << process.readAllStandardError().toStdString();
+        }
+
+        std::vector< SExecJournalEntry > entries()
+        {
+            std::vector< SExecJournalEntry > retVal;
+            CExecJournalReader reader( fRoot.absoluteFilePath( "journal" ) );
+            EXPECT_TRUE( reader.open() ) << reader.errorString().toStdString();
+            SExecJournalEntry entry;
+            while ( reader.readEntry( entry ) )
+                retVal.push_back( entry );
+            return retVal;
+        }
+
+        // true when exactly one recorded program matches
+        bool hasEntry( const std::vector< SExecJournalEntry > & entries, const QString & workingDir, const std::function< bool( const QStringList & args ) > & match )
+        {
+            return std::count_if( entries.begin(), entries.end(), [ &workingDir, &match ]( const SExecJournalEntry & entry ) { return ( entry.fWorkingDir == workingDir ) && match( entry.fArgs ); } ) == 1;
+        }
+
+        void writeFile( const QString & relPath, const QByteArray & contents )
+        {
+            ASSERT_TRUE( NTestUtils::writeFile( fRoot, relPath, contents ) ) << relPath.toStdString();
+        }
+
+        QTemporaryDir fTmpDir;
+        QDir fRoot;
+    };
+
+    // the sub-make runs in sub and must still find the relative journal directory
+    TEST_F( CExecRecorderTest, SubMake )
+    {
+        ASSERT_TRUE( fRoot.mkpath( "sub" ) );
+        writeFile( "Makefile", "all:\n\t$(MAKE) -C sub\n\techo top > top.txt\n" );
+        writeFile( "sub/Makefile", "all:\n\ttouch sub.txt\n" );
+        run( "make", QStringList() << "-s" );
+
+        auto recorded = entries();
+        EXPECT_TRUE( hasEntry( recorded, fRoot.absolutePath(), []( const QStringList & args ) { return args.mid( 1 ) == QStringList( { "-C", "sub" } ); } ) );
+        EXPECT_TRUE( hasEntry( recorded, fRoot.absolutePath(), []( const QStringList & args ) { return !args.isEmpty() && ( args.back() == "echo top > top.txt" ); } ) );
+        EXPECT_TRUE( hasEntry( recorded, fRoot.absoluteFilePath( "sub" ), []( const QStringList & args ) { return args == QStringList( { "touch", "sub.txt" } ); } ) );
+    }
+
+    // a spawn is recorded with the directory its chdir or fchdir file action moves the child to
+    TEST_F( CExecRecorderTest, SpawnFileActions )
+    {
+        ASSERT_TRUE( fRoot.mkpath( "sub" ) );
+        ASSERT_TRUE( fRoot.mkpath( "other" ) );
+        run( VSPM_EXEC_RECORDER_SPAWN, QStringList() << "sub" << fRoot.absoluteFilePath( "other" ) );
+        ASSERT_TRUE( QFileInfo( fRoot.absoluteFilePath( "sub/chdir.txt" ) ).isFile() );
+        ASSERT_TRUE( QFileInfo( fRoot.absoluteFilePath( "other/fchdir.txt" ) ).isFile() );
+
+        auto recorded = entries();
+        EXPECT_TRUE( hasEntry( recorded, fRoot.absoluteFilePath( "sub" ), []( const QStringList & args ) { return args == QStringList( { "touch", "chdir.txt" } ); } ) );
+        EXPECT_TRUE( hasEntry( recorded, fRoot.absoluteFilePath( "other" ), []( const QStringList & args ) { return args == QStringList( { "touch", "fchdir.txt" } ); } ) );
+    }
+}
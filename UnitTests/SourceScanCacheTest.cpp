@@ -0,0 +1,103 @@
+// The MIT License( MIT )
+//
+// Copyright( c ) 2020-2021 Scott Aron Bloom
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files( the "Software" ), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sub-license, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions :
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "MainLib/SourceTreeWalker.h"
+#include "TestUtils.h"
+
+#include <QTemporaryDir>
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+namespace NVSProjectMaker
+{
+    class CSourceScanCacheTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+            ASSERT_TRUE( fTmpDir.isValid() );
+            QDir( fTmpDir.path() ).mkpath( "src" );
+            fSourceDir = QDir( QDir( fTmpDir.path() ).absoluteFilePath( "src" ) );
+            fCacheFile = QDir( fTmpDir.path() ).absoluteFilePath( "test.scancache" ); // outside the tree, saving it must not change the tree
+            fSettings = std::make_shared< SScanSettings >( TStringSet(), QStringList(), TExecNameType(), std::unordered_set< QString >(), QStringList(), false );
+        }
+
+        void writeFile( const QString & relPath, const QByteArray & contents )
+        {
+            ASSERT_TRUE( NTestUtils::writeFile( fSourceDir, relPath, contents ) ) << relPath.toStdString();
+        }
+
+        // scans with the cache left by the previous scan, and compares the tree with a scan without a cache
+        void rescan( int expectedReused )
+        {
+            auto cache = std::make_shared< CSourceScanCache >( fCacheFile, fSourceDir.absolutePath() );
+            cache->load();
+            auto cachedRoot = std::make_shared< SSourceFileInfo >();
+            CSourceTreeWalker walker( fSettings, fSourceDir );
+            walker.setCache( cache );
+            ASSERT_TRUE( walker.walk( fSourceDir.absolutePath(), cachedRoot ) );
+            ASSERT_TRUE( cache->save() );
+
+            auto fullRoot = std::make_shared< SSourceFileInfo >();
+            ASSERT_TRUE( CSourceTreeWalker( fSettings, fSourceDir ).walk( fSourceDir.absolutePath(), fullRoot ) );
+
+            EXPECT_EQ( walker.numReused(), expectedReused );
+            EXPECT_EQ( CSourceTreeWalker::listing( cachedRoot ).join( "\n" ).toStdString(), CSourceTreeWalker::listing( fullRoot ).join( "\n" ).toStdString() );
+        }
+
+        QTemporaryDir fTmpDir;
+        QDir fSourceDir;
+        QString fCacheFile;
+        std::shared_ptr< const SScanSettings > fSettings;
+    };
+
+    TEST_F( CSourceScanCacheTest, RescanMatchesFullScan )
+    {
+        for ( auto && ii : { "a/b", "c", "d/x", "g" } )
+            ASSERT_TRUE( fSourceDir.mkpath( ii ) );
+        for ( auto && ii : { "main.cpp", "a/a.cpp", "a/b/b.h", "c/c1.cpp", "c/c2.cpp", "d/d.h", "d/x/x.cpp", "g/g.cpp" } )
+            writeFile( ii, QByteArray( "// " ) + ii + "\n" );
+
+        // everything above is old enough for the cache to trust, r changes too close to the first scan
+        std::this_thread::sleep_for( std::chrono::milliseconds( 2100 ) );
+        ASSERT_TRUE( fSourceDir.mkpath( "r" ) );
+        writeFile( "r/r1.cpp", "// r1\n" );
+
+        rescan( 0 );
+
+        writeFile( "a/a2.cpp", "// a2\n" );
+        ASSERT_TRUE( QFile::remove( fSourceDir.absoluteFilePath( "c/c2.cpp" ) ) );
+        ASSERT_TRUE( fSourceDir.mkpath( "e" ) );
+        writeFile( "e/e.cpp", "// e\n" );
+        ASSERT_TRUE( QDir( fSourceDir.absoluteFilePath( "g" ) ).removeRecursively() );
+        writeFile( "d/x/x.cpp", "// x, edited\n" );
+        writeFile( "r/r2.cpp", "// r2\n" );
+        // a/b, d and d/x are unchanged and old, the rest changed or is new
+        rescan( 3 );
+
+        // everything changed above is still within 2 seconds of the last scan, so it is listed again
+        rescan( 3 );
+    }
+}
@@ -23,6 +23,12 @@
 #include "MainWindow/MainWindow.h"
 #include "MainLib/VSProjectMaker.h"
 #include "MainLib/Settings.h"
+#include "MainLib/BuildInfoData.h"
+#include "MainLib/DirInfo.h"
+#include "MainLib/FlagFactoring.h"
+#include "MainLib/FlatSourceTree.h"
+#include "MainLib/IncludeScanner.h"
+#include "MainLib/PchRecommender.h"
 #include "SABUtils/ConsoleUtils.h"
 #include "SABUtils/utils.h"
 
@@ -66,6 +72,12 @@ int runCLI(QSharedPointer< QCoreApplication > & appl)
 
     QCommandLineOption optionsFileOption(QStringList() << "options" << "o", "The options INI file (required)", "Options file");
     parser.addOption(optionsFileOption);
+    QCommandLineOption statsOption(QStringList() << "stats", "Load the build output data file(s) from the options file and print where the time went");
+    parser.addOption(statsOption);
+    QCommandLineOption factorFlagsOption(QStringList() << "factor-flags", "Load the build output data file(s) from the options file and print the flags shared per directory and per target");
+    parser.addOption(factorFlagsOption);
+    QCommandLineOption includeGraphOption(QStringList() << "include-graph", "Find the source files, print the most included headers and the largest include closures, and exit");
+    parser.addOption(includeGraphOption);
     parser.setSingleDashWordOptionMode(QCommandLineParser::ParseAsLongOptions);
 
     if (!parser.parse(appl->arguments()))
@@ -113,12 +125,46 @@ int runCLI(QSharedPointer< QCoreApplication > & appl)
         return waitForPrompt( consoleCreated, -1);
     }
 
+    if (parser.isSet(statsOption) || parser.isSet(factorFlagsOption))
+    {
+        if (settings.getBuildOutputDataFile().isEmpty())
+        {
+            std::cerr << "-stats and -factor-flags require a build output data file in the options file\n";
+            return waitForPrompt( consoleCreated, -1);
+        }
+        std::cout << "Loading build output data\n";
+        NVSProjectMaker::CBuildInfoData buildInfo(settings.getBuildOutputDataFile(), [](const QString & msg) { std::cout << msg.toStdString() << "\n"; }, &settings, nullptr, parser.isSet(statsOption));
+        if (!buildInfo.status())
+        {
+            std::cerr << buildInfo.errorString().toStdString() << "\n";
+            return waitForPrompt( consoleCreated, -1);
+        }
+        if (parser.isSet(factorFlagsOption))
+        {
+            std::cout
+                << "============================================" << "\n"
+                << "Per Directory" << "\n"
+                << NVSProjectMaker::CFlagFactoring::getText(NVSProjectMaker::CFlagFactoring::byDirectory(buildInfo)).toStdString() << "\n"
+                << "============================================" << "\n"
+                << "Per Target" << "\n"
+                << NVSProjectMaker::CFlagFactoring::getText(NVSProjectMaker::CFlagFactoring::byTarget(buildInfo)).toStdString() << "\n";
+        }
+        if (parser.isSet(statsOption))
+        {
+            std::cout
+                << "============================================" << "\n"
+                << buildInfo.stats().getText().toStdString() << "\n";
+        }
+        return waitForPrompt( consoleCreated, 0);
+    }
+
     auto clientDir = QDir(settings.getClientDir());
     if (!clientDir.exists())
     {
         std::cerr << "Client directory '" << clientDir.absolutePath().toStdString() << "' does not exist.\n";
         return waitForPrompt( consoleCreated, -1);
     }
+
     std::cout << "Finding directories\n";
     if (settings.loadSourceFiles(clientDir.absoluteFilePath(settings.getSourceRelativeDir()), clientDir.absoluteFilePath(settings.getSourceRelativeDir()), nullptr,
         [](const QString & msg) { std::cout << msg.toStdString() << "\n"; }))
@@ -132,6 +178,37 @@ int runCLI(QSharedPointer< QCoreApplication > & appl)
         << "============================================" << "\n"
         << settings.getResults()->getText(true).toStdString() << "\n";
 
+    if (parser.isSet(includeGraphOption))
+    {
+        std::cout << "Scanning #include directives\n";
+        auto graph = NVSProjectMaker::CIncludeScanner(&settings).scan(nullptr);
+        std::cout
+            << "============================================" << "\n"
+            << graph->getText(20).toStdString() << "\n";
+
+        auto recommender = NVSProjectMaker::CPchRecommender(graph, nullptr, settings.getSourceDir().value());
+        std::cout
+            << "============================================" << "\n"
+            << "Precompiled Header Candidates" << "\n";
+        auto tree = NVSProjectMaker::CFlatSourceTree(settings.getResults()->fRootDir);
+        settings.getParentOfPairDirectoriesMap(tree, nullptr);
+        for (auto && ii : settings.getDirInfo(tree, nullptr))
+        {
+            if (ii->fSourceFiles.isEmpty())
+                continue;
+            auto recommendation = recommender.recommend(*ii);
+            if (!recommendation->isEmpty())
+                std::cout << recommendation->getText().toStdString() << "\n";
+        }
+        return waitForPrompt( consoleCreated, 0);
+    }
+
+    if (settings.getRecommendPchHeaders())
+    {
+        std::cout << "Scanning #include directives for precompiled header candidates\n";
+        settings.setPchRecommender(std::make_shared< NVSProjectMaker::CPchRecommender >(NVSProjectMaker::CIncludeScanner(&settings).scan(nullptr), nullptr, settings.getSourceDir().value()));
+    }
+
     settings.generate(nullptr, nullptr,
         [](const QString & msg) { std::cout << msg.toStdString() << "\n"; }
     );